@@ -0,0 +1,69 @@
+#include "address_index.h"
+
+#include <algorithm>
+
+namespace stabs {
+
+    AddressIndex::BankTables::BankTables()
+        : line(AddressSpaceSize, InvalidIndex)
+        , function(AddressSpaceSize, InvalidIndex)
+        , label(AddressSpaceSize, InvalidIndex) {}
+
+    AddressIndex::AddressIndex(const DebugInfo& info)
+        : m_info(info) {
+        for (uint32_t i = 0; i < info.functions.size(); ++i) {
+            const Function& function = info.functions[i];
+            Table& table = Tables(function.bank).function;
+            for (uint32_t a = function.start; a < function.end && a < AddressSpaceSize; ++a)
+                table[a] = i;
+        }
+
+        // First label wins, so a function's own label is preferred over local ones at the same
+        // address
+        for (uint32_t i = 0; i < info.labels.size(); ++i) {
+            const Label& label = info.labels[i];
+            if (label.address < AddressSpaceSize) {
+                uint32_t& slot = Tables(label.bank).label[label.address];
+                if (slot == InvalidIndex)
+                    slot = i;
+            }
+        }
+
+        // A line entry covers every address up to the next entry in the same bank, without
+        // running past the end of its function.
+        std::vector<uint32_t> order(info.lines.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const LineEntry& la = info.lines[a];
+            const LineEntry& lb = info.lines[b];
+            return la.bank != lb.bank ? la.bank < lb.bank : la.address < lb.address;
+        });
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            const LineEntry& entry = info.lines[order[i]];
+            if (entry.address >= AddressSpaceSize)
+                continue;
+            BankTables& tables = Tables(entry.bank);
+
+            uint32_t end = entry.address + 1;
+            if (const uint32_t f = tables.function[entry.address]; f != InvalidIndex) {
+                end = info.functions[f].end;
+                if (i + 1 < order.size()) {
+                    const LineEntry& next = info.lines[order[i + 1]];
+                    if (next.bank == entry.bank)
+                        end = std::min(end, std::max(next.address, entry.address + 1));
+                }
+            }
+            for (uint32_t a = entry.address; a < end && a < AddressSpaceSize; ++a)
+                tables.line[a] = order[i];
+        }
+    }
+
+    AddressIndex::BankTables& AddressIndex::Tables(BankId bank) {
+        if (!m_banks[bank])
+            m_banks[bank] = std::make_unique<BankTables>();
+        return *m_banks[bank];
+    }
+
+} // namespace stabs
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    // Constant-time (bank, address) lookups into the line table, function ranges and labels. Each
+    // bank that has code gets dense 64K tables; banks without code cost nothing.
+    //
+    // The overloads without a bank use the active bank reported by the emulator through
+    // SetActiveBankProvider (bank 0 if none is set).
+    class AddressIndex {
+    public:
+        explicit AddressIndex(const DebugInfo& info);
+
+        void SetActiveBankProvider(std::function<BankId()> provider) {
+            m_activeBank = std::move(provider);
+        }
+        BankId ActiveBank() const { return m_activeBank ? m_activeBank() : 0; }
+
+        // Line entry covering the instruction at address, or nullptr
+        const LineEntry* FindLine(BankId bank, uint32_t address) const {
+            return Find(m_info.lines, &BankTables::line, bank, address);
+        }
+        // Function whose code range contains address, or nullptr
+        const Function* FindFunction(BankId bank, uint32_t address) const {
+            return Find(m_info.functions, &BankTables::function, bank, address);
+        }
+        // Label defined exactly at address, or nullptr
+        const Label* FindLabel(BankId bank, uint32_t address) const {
+            return Find(m_info.labels, &BankTables::label, bank, address);
+        }
+
+        const LineEntry* FindLine(uint32_t address) const {
+            return FindLine(ActiveBank(), address);
+        }
+        const Function* FindFunction(uint32_t address) const {
+            return FindFunction(ActiveBank(), address);
+        }
+        const Label* FindLabel(uint32_t address) const { return FindLabel(ActiveBank(), address); }
+
+    private:
+        using Table = std::vector<uint32_t>;
+
+        struct BankTables {
+            BankTables();
+            Table line;
+            Table function;
+            Table label;
+        };
+
+        template <typename T>
+        const T* Find(const std::vector<T>& records, Table BankTables::*table, BankId bank,
+                      uint32_t address) const {
+            const BankTables* tables = m_banks[bank].get();
+            if (!tables || address >= AddressSpaceSize)
+                return nullptr;
+            const uint32_t index = (tables->*table)[address];
+            return index != InvalidIndex ? &records[index] : nullptr;
+        }
+
+        BankTables& Tables(BankId bank);
+
+        const DebugInfo& m_info;
+        std::array<std::unique_ptr<BankTables>, MaxBanks> m_banks;
+        std::function<BankId()> m_activeBank;
+    };
+
+    // One bit per (bank, address) that has been executed
+    class CoverageMap {
+    public:
+        void Mark(BankId bank, uint32_t address) {
+            auto& bits = m_banks[bank];
+            if (bits.empty())
+                bits.resize(AddressSpaceSize / 64);
+            bits[(address & 0xFFFF) / 64] |= uint64_t{1} << (address % 64);
+        }
+
+        bool IsCovered(BankId bank, uint32_t address) const {
+            auto& bits = m_banks[bank];
+            return !bits.empty() && (bits[(address & 0xFFFF) / 64] >> (address % 64) & 1) != 0;
+        }
+
+        void Clear() {
+            for (auto& bits : m_banks)
+                bits.clear();
+        }
+
+    private:
+        std::array<std::vector<uint64_t>, MaxBanks> m_banks;
+    };
+
+} // namespace stabs
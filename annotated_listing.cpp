@@ -0,0 +1,85 @@
+#include "annotated_listing.h"
+
+#include <numeric>
+
+#include "buffered_writer.h"
+#include "listing_scan.h"
+#include "mapped_file.h"
+
+namespace stabs {
+    namespace {
+        constexpr int CyclesWidth = 10;
+        constexpr int AccessesWidth = 8;
+        //   cycles  share  executed  accesses  '|'
+        constexpr std::string_view BlankColumns = "                                | ";
+    } // namespace
+
+    void WriteAnnotatedListing(std::string_view listing, const ListingProfile& profile,
+                               BufferedWriter& out) {
+        const uint64_t totalCycles =
+            profile.cycles ? std::accumulate(profile.cycles->begin(), profile.cycles->end(),
+                                             uint64_t{0})
+                           : 0;
+
+        out.Write("    cycles  share   accesses    | \n");
+        while (!listing.empty()) {
+            const size_t eol = listing.find('\n');
+            const std::string_view line = listing.substr(0, eol);
+            listing.remove_prefix(eol == std::string_view::npos ? listing.size() : eol + 1);
+
+            std::string_view rest = line;
+            uint32_t address = 0;
+            if (!ParseLineAddress(rest, address)) {
+                out.Write(BlankColumns);
+                out.Write(line);
+                out.Put('\n');
+                continue;
+            }
+
+            const bool instruction = IsInstruction(rest);
+            const uint64_t cycles =
+                instruction && profile.cycles && address < profile.cycles->size()
+                    ? (*profile.cycles)[address]
+                    : 0;
+            if (cycles != 0) {
+                out.WriteUnsigned(cycles, CyclesWidth);
+                // Tenths of a percent
+                const uint64_t share = cycles * 1000 / totalCycles;
+                out.WriteUnsigned(share / 10, 4);
+                out.Put('.');
+                out.Put(static_cast<char>('0' + share % 10));
+                out.Put('%');
+            } else {
+                out.Write("                 ");
+            }
+
+            char executed = ' ';
+            if (instruction && profile.coverage)
+                executed = profile.coverage->IsCovered(profile.bank, address) ? '*' : '!';
+            out.Put(' ');
+            out.Put(executed);
+            out.Put(' ');
+
+            const uint32_t accesses = profile.accesses && address < profile.accesses->size()
+                                          ? (*profile.accesses)[address]
+                                          : 0;
+            if (accesses != 0)
+                out.WriteUnsigned(accesses, AccessesWidth);
+            else
+                out.Write("        ");
+            out.Write("    | ");
+            out.Write(line);
+            out.Put('\n');
+        }
+    }
+
+    bool WriteAnnotatedListingFile(const std::string& path, const ListingProfile& profile,
+                                   BufferedWriter& out) {
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+        WriteAnnotatedListing(file.Data(), profile, out);
+        return true;
+    }
+
+} // namespace stabs
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "address_index.h"
+#include "debug_info.h"
+
+namespace stabs {
+
+    class BufferedWriter;
+
+    // What the emulator measured for the code and data of one bank; any part may be missing
+    struct ListingProfile {
+        BankId bank = 0;
+        const std::vector<uint64_t>* cycles = nullptr;   // Cycles spent per instruction address
+        const CoverageMap* coverage = nullptr;           // Executed instructions
+        const std::vector<uint32_t>* accesses = nullptr; // Data accesses per address
+    };
+
+    // Writes the listing with cost columns in front of every line: the cycles of the
+    // instruction and their share of the total, whether it was executed ('*', or '!' for
+    // instructions never executed), and the data accesses to the line's address. Lines are
+    // found and their addresses read straight from the text, and copied out as they are, so the
+    // listing is read and the output written in one sequential pass.
+    void WriteAnnotatedListing(std::string_view listing, const ListingProfile& profile,
+                               BufferedWriter& out);
+
+    // Returns false if the file could not be read
+    bool WriteAnnotatedListingFile(const std::string& path, const ListingProfile& profile,
+                                   BufferedWriter& out);
+
+} // namespace stabs
@@ -0,0 +1,110 @@
+#include "buffered_writer.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace stabs {
+
+    BufferedWriter::BufferedWriter(std::FILE* file, size_t capacity)
+        : m_file(file)
+        , m_buffer(new char[std::max<size_t>(capacity, 64)])
+        , m_capacity(std::max<size_t>(capacity, 64)) {}
+
+    void BufferedWriter::Flush() {
+        if (m_size != 0 && std::fwrite(m_buffer.get(), 1, m_size, m_file) != m_size)
+            m_failed = true;
+        m_size = 0;
+    }
+
+    // Text larger than the free space: fill the buffer, then write what is left directly
+    void BufferedWriter::WriteLarge(std::string_view text) {
+        const size_t head = m_capacity - m_size;
+        std::memcpy(m_buffer.get() + m_size, text.data(), head);
+        m_size = m_capacity;
+        Flush();
+        text.remove_prefix(head);
+        if (text.size() >= m_capacity) {
+            if (std::fwrite(text.data(), 1, text.size(), m_file) != text.size())
+                m_failed = true;
+            return;
+        }
+        std::memcpy(m_buffer.get(), text.data(), text.size());
+        m_size = text.size();
+    }
+
+    void BufferedWriter::WriteUnsigned(uint64_t value) {
+        char* p = Reserve(20);
+        m_size = static_cast<size_t>(std::to_chars(p, p + 20, value).ptr - m_buffer.get());
+    }
+
+    void BufferedWriter::WriteUnsigned(uint64_t value, int width) {
+        char digits[20];
+        const char* end = std::to_chars(digits, digits + 20, value).ptr;
+        for (auto length = end - digits; length < width; ++length)
+            Put(' ');
+        Write({digits, static_cast<size_t>(end - digits)});
+    }
+
+    void BufferedWriter::WriteSigned(int64_t value) {
+        char* p = Reserve(20);
+        m_size = static_cast<size_t>(std::to_chars(p, p + 20, value).ptr - m_buffer.get());
+    }
+
+    void BufferedWriter::WriteHex(uint32_t value, int digits) {
+        static constexpr char hex[] = "0123456789ABCDEF";
+        digits = std::clamp(digits, 1, 8);
+        while (digits < 8 && (value >> (digits * 4)) != 0)
+            ++digits;
+        char* p = Reserve(8);
+        for (int i = digits - 1; i >= 0; --i, value >>= 4)
+            p[i] = hex[value & 0xF];
+        m_size += static_cast<size_t>(digits);
+    }
+
+    void BufferedWriter::WriteJsonString(std::string_view text) {
+        static constexpr char hex[] = "0123456789abcdef";
+        Put('"');
+        size_t run = 0; // Characters that need no escape, written in one piece
+        for (size_t i = 0; i < text.size(); ++i) {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            Write(text.substr(run, i - run));
+            run = i + 1;
+            char escape = 0;
+            switch (c) {
+            case '"':
+            case '\\':
+                escape = static_cast<char>(c);
+                break;
+            case '\n':
+                escape = 'n';
+                break;
+            case '\r':
+                escape = 'r';
+                break;
+            case '\t':
+                escape = 't';
+                break;
+            }
+
+            char* p = Reserve(6);
+            p[0] = '\\';
+            if (escape != 0) {
+                p[1] = escape;
+                m_size += 2;
+            } else {
+                // Other control characters: \u00XX
+                p[1] = 'u';
+                p[2] = '0';
+                p[3] = '0';
+                p[4] = hex[c >> 4];
+                p[5] = hex[c & 0xF];
+                m_size += 6;
+            }
+        }
+        Write(text.substr(run));
+        Put('"');
+    }
+
+} // namespace stabs
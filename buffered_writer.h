@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+namespace stabs {
+
+    // Text output through one large buffer that is written to the file in whole chunks, for
+    // reports and exports that write millions of small pieces. Integers are formatted in place
+    // with std::to_chars. Flushed on destruction.
+    class BufferedWriter {
+    public:
+        static constexpr size_t DefaultCapacity = 1 << 20;
+
+        explicit BufferedWriter(std::FILE* file, size_t capacity = DefaultCapacity);
+        BufferedWriter(const BufferedWriter&) = delete;
+        BufferedWriter& operator=(const BufferedWriter&) = delete;
+        ~BufferedWriter() { Flush(); }
+
+        void Write(std::string_view text) {
+            if (text.size() > m_capacity - m_size) {
+                WriteLarge(text);
+                return;
+            }
+            std::memcpy(m_buffer.get() + m_size, text.data(), text.size());
+            m_size += text.size();
+        }
+        void Put(char c) {
+            if (m_size == m_capacity)
+                Flush();
+            m_buffer[m_size++] = c;
+        }
+
+        void WriteUnsigned(uint64_t value);
+        // Right-aligned in width columns, padded with blanks
+        void WriteUnsigned(uint64_t value, int width);
+        void WriteSigned(int64_t value);
+        // Upper case, zero padded to digits: WriteHex(0xC88, 4) -> "0C88"
+        void WriteHex(uint32_t value, int digits);
+        // The string in double quotes, with JSON escapes
+        void WriteJsonString(std::string_view text);
+
+        void Flush();
+        // True if writing to the file failed
+        bool Failed() const { return m_failed; }
+
+    private:
+        // Room for at least count bytes (count <= 32)
+        char* Reserve(size_t count) {
+            if (m_capacity - m_size < count)
+                Flush();
+            return m_buffer.get() + m_size;
+        }
+        void WriteLarge(std::string_view text);
+
+        std::FILE* m_file;
+        std::unique_ptr<char[]> m_buffer;
+        size_t m_capacity;
+        size_t m_size = 0;
+        bool m_failed = false;
+    };
+
+} // namespace stabs
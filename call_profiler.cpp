@@ -0,0 +1,97 @@
+#include "call_profiler.h"
+
+#include <string>
+
+namespace stabs {
+
+    CallProfiler::CallProfiler(const DebugInfo& info, const AddressIndex& index)
+        : m_info(info)
+        , m_index(index) {
+        Reset(0);
+    }
+
+    void CallProfiler::Reset(uint64_t cycles) {
+        m_nodes.assign(1, Node{});
+        m_stack.assign(1, Frame{0, cycles, 0});
+    }
+
+    // Children are kept in a list with the most recently added first
+    uint32_t CallProfiler::Child(uint32_t parent, uint32_t function) {
+        for (uint32_t child = m_nodes[parent].firstChild; child != InvalidIndex;
+             child = m_nodes[child].nextSibling) {
+            if (m_nodes[child].function == function)
+                return child;
+        }
+        const auto child = static_cast<uint32_t>(m_nodes.size());
+        Node node;
+        node.function = function;
+        node.parent = parent;
+        node.nextSibling = m_nodes[parent].firstChild;
+        m_nodes[parent].firstChild = child;
+        m_nodes.push_back(node);
+        return child;
+    }
+
+    void CallProfiler::OnCall(BankId bank, uint32_t target, uint64_t cycles) {
+        const Function* function = m_index.FindFunction(bank, target);
+        const uint32_t id = function ? static_cast<uint32_t>(function - m_info.functions.data())
+                                     : InvalidIndex;
+        const uint32_t node = Child(m_stack.back().node, id);
+        ++m_nodes[node].calls;
+        m_stack.push_back({node, cycles, 0});
+    }
+
+    // Returns the frame's inclusive cycles
+    uint64_t CallProfiler::Close(const Frame& frame, uint64_t cycles) {
+        const uint64_t inclusive = cycles - frame.entryCycles;
+        Node& node = m_nodes[frame.node];
+        node.inclusiveCycles += inclusive;
+        node.exclusiveCycles += inclusive - frame.childCycles;
+        return inclusive;
+    }
+
+    void CallProfiler::OnReturn(uint64_t cycles) {
+        if (m_stack.size() == 1)
+            return;
+        const uint64_t inclusive = Close(m_stack.back(), cycles);
+        m_stack.pop_back();
+        m_stack.back().childCycles += inclusive;
+    }
+
+    // Innermost first, so each frame's open call counts as a child
+    void CallProfiler::Flush(uint64_t cycles) {
+        uint64_t openChild = 0;
+        for (auto frame = m_stack.rbegin(); frame != m_stack.rend(); ++frame) {
+            frame->childCycles += openChild;
+            openChild = Close(*frame, cycles);
+            frame->entryCycles = cycles;
+            frame->childCycles = 0;
+        }
+    }
+
+    void CallProfiler::WriteFolded(std::ostream& out) const {
+        std::vector<uint32_t> path;
+        std::string line;
+        for (uint32_t i = 1; i < m_nodes.size(); ++i) {
+            if (m_nodes[i].exclusiveCycles == 0)
+                continue;
+            path.clear();
+            for (uint32_t n = i; n != 0; n = m_nodes[n].parent)
+                path.push_back(m_nodes[n].function);
+
+            line.clear();
+            for (auto f = path.rbegin(); f != path.rend(); ++f) {
+                if (!line.empty())
+                    line += ';';
+                if (*f == InvalidIndex)
+                    line += "[unknown]";
+                else
+                    line += m_info.strings.Get(m_info.symbols[m_info.functions[*f].symbol].name);
+            }
+            out << line << ' ' << m_nodes[i].exclusiveCycles << '\n';
+        }
+        if (m_nodes[0].exclusiveCycles != 0)
+            out << "[root] " << m_nodes[0].exclusiveCycles << '\n';
+    }
+
+} // namespace stabs
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "address_index.h"
+#include "debug_info.h"
+
+namespace stabs {
+
+    // Exact call-graph profile from the emulator's jsr/bsr/lbsr and rts events and its cycle
+    // counter. A shadow call stack follows the calls; every distinct call path gets a node of a
+    // calling-context tree keyed by function index (DebugInfo::functions), which accumulates
+    // the cycles spent in the path's last function (exclusive) and in everything it called
+    // (inclusive). An event is a function lookup in the AddressIndex, a walk over the children
+    // of the current node, and no allocation once the tree has grown.
+    //
+    // Calls to code outside any known function (BIOS routines, code without debug info) get
+    // nodes with function InvalidIndex. Returns without a matching call (e.g. from the function
+    // that was running when profiling started) are ignored, so its cycles go to the root.
+    class CallProfiler {
+    public:
+        struct Node {
+            uint32_t function = InvalidIndex; // Index into DebugInfo::functions
+            uint32_t parent = InvalidIndex;
+            uint32_t firstChild = InvalidIndex;
+            uint32_t nextSibling = InvalidIndex;
+            uint64_t calls = 0;
+            uint64_t inclusiveCycles = 0;
+            uint64_t exclusiveCycles = 0;
+        };
+
+        CallProfiler(const DebugInfo& info, const AddressIndex& index);
+
+        // Starts (or restarts) profiling at the given cycle count, clearing the tree
+        void Reset(uint64_t cycles);
+
+        // A call to target was executed; cycles is the emulator's cycle counter
+        void OnCall(BankId bank, uint32_t target, uint64_t cycles);
+        void OnReturn(uint64_t cycles);
+
+        // Charges the cycles since the last event to the frames still on the shadow stack, e.g.
+        // before reading the tree at the end of a game frame
+        void Flush(uint64_t cycles);
+
+        // Node 0 is the root: code running outside any call seen since Reset
+        const std::vector<Node>& Nodes() const { return m_nodes; }
+        size_t Depth() const { return m_stack.size() - 1; }
+
+        // One line per call path with its exclusive cycles, in the folded stack format of
+        // flamegraph.pl and speedscope: "main;update;draw 1234"
+        void WriteFolded(std::ostream& out) const;
+
+    private:
+        struct Frame {
+            uint32_t node;
+            uint64_t entryCycles;
+            uint64_t childCycles; // Inclusive cycles of calls that have returned
+        };
+
+        uint32_t Child(uint32_t parent, uint32_t function);
+        uint64_t Close(const Frame& frame, uint64_t cycles);
+
+        const DebugInfo& m_info;
+        const AddressIndex& m_index;
+        std::vector<Node> m_nodes;
+        std::vector<Frame> m_stack;
+    };
+
+} // namespace stabs
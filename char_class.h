@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STABS_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace stabs {
+
+    // A set of bytes given as pairs of inclusive bounds: CharSet<'a', 'z', '_', '_'>. Contains()
+    // is a lookup in a 256-entry table. Span() compares 16 bytes at a time against the ranges
+    // where SSE2 is available, so skipping a run of the set costs little more than a memchr.
+    template <char... BOUNDS>
+    class CharSet {
+        static_assert(sizeof...(BOUNDS) % 2 == 0, "CharSet takes pairs of bounds");
+
+    public:
+        static bool Contains(char c) { return Table[static_cast<uint8_t>(c)]; }
+
+        // Number of bytes from begin that are in the set
+        static size_t Span(const char* begin, const char* end) {
+            const char* p = begin;
+#ifdef STABS_SSE2
+            for (; end - p >= 16; p += 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                const uint32_t mismatches =
+                    ~static_cast<uint32_t>(_mm_movemask_epi8(Matches(chunk))) & 0xFFFF;
+                if (mismatches != 0)
+                    return static_cast<size_t>(p - begin) + CountTrailingZeros(mismatches);
+            }
+#endif
+            while (p != end && Contains(*p))
+                ++p;
+            return static_cast<size_t>(p - begin);
+        }
+
+    private:
+        static constexpr std::array<bool, 256> MakeTable() {
+            std::array<bool, 256> table{};
+            constexpr char bounds[] = {BOUNDS...};
+            for (size_t i = 0; i < sizeof(bounds); i += 2) {
+                const int lo = static_cast<uint8_t>(bounds[i]);
+                const int hi = static_cast<uint8_t>(bounds[i + 1]);
+                for (int c = lo; c <= hi; ++c)
+                    table[c] = true;
+            }
+            return table;
+        }
+
+        static constexpr std::array<bool, 256> Table = MakeTable();
+
+#ifdef STABS_SSE2
+        // 0xFF in each byte of chunk that is in the set
+        static __m128i Matches(__m128i chunk) {
+            constexpr char bounds[] = {BOUNDS...};
+            __m128i matches = _mm_setzero_si128();
+            for (size_t i = 0; i < sizeof(bounds); i += 2) {
+                const char lo = bounds[i], hi = bounds[i + 1];
+                if (lo == hi) {
+                    matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(lo)));
+                } else {
+                    // Unsigned lo <= c <= hi as one signed compare: shift lo down to -128
+                    const __m128i shifted =
+                        _mm_add_epi8(chunk, _mm_set1_epi8(static_cast<char>(128 - lo)));
+                    const __m128i limit = _mm_set1_epi8(static_cast<char>(hi - lo + 1 - 128));
+                    matches = _mm_or_si128(matches, _mm_cmplt_epi8(shifted, limit));
+                }
+            }
+            return matches;
+        }
+
+        static uint32_t CountTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+        }
+#endif
+    };
+
+    // Characters of C identifiers
+    using IdentifierFirstSet = CharSet<'a', 'z', 'A', 'Z', '_', '_'>;
+    using IdentifierOtherSet = CharSet<'a', 'z', 'A', 'Z', '0', '9', '_', '_'>;
+    using DigitSet = CharSet<'0', '9'>;
+
+} // namespace stabs
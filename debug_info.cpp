@@ -0,0 +1,158 @@
+#include "debug_info.h"
+
+#include <cstring>
+
+namespace stabs {
+
+    StringPool::StringPool() { Clear(); }
+
+    StrId StringPool::Intern(std::string_view s) {
+        if (auto it = m_ids.find(s); it != m_ids.end())
+            return it->second;
+
+        char* dest = nullptr;
+        if (s.size() > BlockSize / 4) {
+            // Large strings get their own block so they don't waste the rest of the current one
+            m_largeBlocks.push_back(std::make_unique<char[]>(s.size()));
+            dest = m_largeBlocks.back().get();
+        } else {
+            if (m_blockUsed + s.size() > BlockSize) {
+                m_blocks.push_back(std::make_unique<char[]>(BlockSize));
+                m_blockUsed = 0;
+            }
+            dest = m_blocks.back().get() + m_blockUsed;
+            m_blockUsed += s.size();
+        }
+        std::memcpy(dest, s.data(), s.size());
+
+        const auto id = static_cast<StrId>(m_strings.size());
+        m_strings.emplace_back(dest, s.size());
+        m_ids.emplace(m_strings.back(), id);
+        return id;
+    }
+
+    StrId StringPool::Find(std::string_view s) const {
+        auto it = m_ids.find(s);
+        return it != m_ids.end() ? it->second : InvalidStrId;
+    }
+
+    void StringPool::Clear() {
+        m_blocks.clear();
+        m_largeBlocks.clear();
+        m_blockUsed = BlockSize;
+        m_strings.clear();
+        m_ids.clear();
+        m_strings.emplace_back();
+        m_ids.emplace(std::string_view{}, 0);
+    }
+
+    std::string_view DebugInfo::TypeName(TypeId id) {
+        if (id >= types.size())
+            return "<invalid>";
+
+        // Types are only ever appended between reloads, so existing entries stay valid
+        if (m_typeNames.size() < types.size())
+            m_typeNames.resize(types.size(), InvalidStrId);
+
+        if (m_typeNames[id] == InvalidStrId)
+            m_typeNames[id] = strings.Intern(FormatTypeName(id));
+        return strings.Get(m_typeNames[id]);
+    }
+
+    std::string DebugInfo::FormatTypeName(TypeId id) const {
+        // Build the declarator outwards-in, the way C declarations read:
+        // array of pointers to int is "int*[4]", pointer to array of int is "int (*)[4]".
+        // Qualifiers of a pointer follow its '*' ("char* const"), others precede the leaf name.
+        // A named pointer, array, ... is a typedef, and ends the declarator like any other name.
+        std::string declarator;
+        std::string qualifiers;
+        for (int depth = 0; depth < 64 && id < types.size(); ++depth) {
+            const Type& type = types[id];
+            const TypeKind target = type.target < types.size() && types[type.target].name == 0
+                                        ? types[type.target].kind
+                                        : TypeKind::Unknown;
+            switch (type.name == 0 ? type.kind : TypeKind::Unknown) {
+            case TypeKind::Pointer:
+                if (target == TypeKind::Array || target == TypeKind::Function)
+                    declarator = "(*" + declarator + ")";
+                else
+                    declarator.insert(0, "*");
+                id = type.target;
+                continue;
+
+            case TypeKind::Array:
+                declarator += "[" + std::to_string(type.count) + "]";
+                id = type.target;
+                continue;
+
+            case TypeKind::Function:
+                declarator += "()";
+                id = type.target;
+                continue;
+
+            case TypeKind::Const:
+            case TypeKind::Volatile: {
+                const char* qualifier = type.kind == TypeKind::Const ? "const" : "volatile";
+                if (target == TypeKind::Pointer)
+                    declarator.insert(0, std::string(" ") + qualifier);
+                else
+                    qualifiers += std::string(qualifier) + " ";
+                id = type.target;
+                continue;
+            }
+
+            case TypeKind::Typedef:
+                id = type.target;
+                continue;
+
+            default:
+                break;
+            }
+
+            std::string result = qualifiers;
+            if (type.name != 0) {
+                result += strings.Get(type.name);
+            } else {
+                switch (type.kind) {
+                case TypeKind::Enum:
+                    result += "<anonymous enum>";
+                    break;
+                case TypeKind::Struct:
+                    result += "<anonymous struct>";
+                    break;
+                case TypeKind::Union:
+                    result += "<anonymous union>";
+                    break;
+                default:
+                    result += "<type " + std::to_string(type.stabsId) + ">";
+                    break;
+                }
+            }
+            if (!declarator.empty() && declarator[0] == '(')
+                result += ' ';
+            return result + declarator;
+        }
+        return "<unknown>" + declarator;
+    }
+
+    void DebugInfo::Clear() {
+        strings.Clear();
+        units.clear();
+        types.clear();
+        members.clear();
+        enumerators.clear();
+        baseClasses.clear();
+        methods.clear();
+        symbols.clear();
+        labels.clear();
+        functions.clear();
+        stackDepths.clear();
+        calls.clear();
+        extendedReferences.clear();
+        lines.clear();
+        variables.clear();
+        scopes.clear();
+        m_typeNames.clear();
+    }
+
+} // namespace stabs
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace stabs {
+
+    // Index of a string in a StringPool. 0 is always the empty string.
+    using StrId = uint32_t;
+    constexpr StrId InvalidStrId = ~StrId{0};
+
+    // Interns strings so that tables can refer to names by id. Characters are stored in blocks
+    // that never move, so views returned by Get() remain valid until Clear().
+    class StringPool {
+    public:
+        StringPool();
+
+        StrId Intern(std::string_view s);
+        // Returns InvalidStrId if the string was never interned
+        StrId Find(std::string_view s) const;
+        std::string_view Get(StrId id) const { return m_strings[id]; }
+        size_t Size() const { return m_strings.size(); }
+        void Clear();
+
+    private:
+        static constexpr size_t BlockSize = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> m_blocks;
+        std::vector<std::unique_ptr<char[]>> m_largeBlocks;
+        size_t m_blockUsed = BlockSize;
+        std::vector<std::string_view> m_strings;
+        std::unordered_map<std::string_view, StrId> m_ids;
+    };
+
+    // Bank of a bank-switched cartridge. Addresses are 16-bit within a bank; every address-keyed
+    // record carries the bank it belongs to.
+    using BankId = uint8_t;
+    constexpr uint32_t MaxBanks = 256;
+
+    // Index into DebugInfo::types
+    using TypeId = uint32_t;
+    constexpr TypeId InvalidTypeId = ~TypeId{0};
+
+    enum class TypeKind : uint8_t {
+        Unknown, // Referenced but not defined in its unit
+        Base,    // Named type, possibly with a range (int, char, ...)
+        Pointer,
+        Array,
+        Enum,
+        Struct,
+        Union,
+        Function, // Target is the return type
+        Const,
+        Volatile,
+        Typedef, // Another name for the target
+    };
+
+    // Access of a C++ base class or member function
+    enum class Access : uint8_t {
+        Private,
+        Protected,
+        Public,
+    };
+
+    struct Type {
+        TypeKind kind = TypeKind::Unknown;
+        StrId name = 0;
+        // Pointer: pointee, Array: element type, Function: return type, Const, Volatile and
+        // Typedef: the type they apply to
+        TypeId target = InvalidTypeId;
+        uint32_t count = 0;       // Array: number of elements
+        uint32_t byteSize = 0;    // 0 if unknown (or a struct that is only declared)
+        uint32_t first = 0;       // Struct, Union: index of first member, Enum: first enumerator
+        uint32_t numChildren = 0; // Struct, Union: member count, Enum: enumerator count
+        uint32_t firstBase = 0;   // Struct: index of first base class
+        uint32_t numBases = 0;
+        uint32_t firstMethod = 0; // Struct, Union: index of first member function
+        uint32_t numMethods = 0;
+        uint32_t unit = 0;        // Compile unit that defines this type
+        int32_t stabsId = 0;      // Type number within its compile unit
+    };
+
+    struct StructMember {
+        StrId name = 0;
+        TypeId type = InvalidTypeId;
+        uint32_t bitOffset = 0;
+        uint32_t bitSize = 0;
+    };
+
+    struct Enumerator {
+        StrId name = 0;
+        int64_t value = 0;
+    };
+
+    struct BaseClass {
+        TypeId type = InvalidTypeId;
+        uint32_t bitOffset = 0;
+        Access access = Access::Public;
+        bool isVirtual = false;
+    };
+
+    // One overload of a C++ member function
+    struct Method {
+        StrId name = 0;
+        StrId physName = 0; // Mangled name, e.g. "_ZN3Foo3getEv"
+        TypeId type = InvalidTypeId;
+        Access access = Access::Public;
+        bool isVirtual = false;
+        bool isStatic = false;
+    };
+
+    constexpr uint32_t InvalidAddress = ~uint32_t{0};
+    constexpr uint32_t AddressSpaceSize = 0x10000;
+    constexpr uint32_t InvalidIndex = ~uint32_t{0};
+
+    enum class SymbolKind : uint8_t {
+        Function,       // 'F'
+        FileStatic,     // 'S'
+        FunctionStatic, // 'V'
+        Global,         // 'G'
+    };
+
+    // Section a symbol is in, from the stab type
+    enum class SymbolSection : uint8_t {
+        Unknown, // N_GSYM (32): globals, placed by their label
+        Text,    // N_FUN (36): code and constants
+        Data,    // N_STSYM (38): initialized variables
+        Bss,     // N_LCSYM (40): uninitialized variables
+    };
+
+    // Section symbol: function or static variable
+    struct Symbol {
+        StrId name = 0;
+        StrId label = 0; // Assembler label, e.g. "__ZL9var_const"
+        StrId file = 0;  // N_SOL file in effect where it is declared; empty for the main file
+        SymbolKind kind = SymbolKind::Function;
+        SymbolSection section = SymbolSection::Unknown;
+        TypeId type = InvalidTypeId; // Variable type, or return type for functions
+        uint32_t address = InvalidAddress;
+        uint32_t unit = 0;
+        BankId bank = 0;
+    };
+
+    struct Label {
+        StrId name = 0;
+        uint32_t address = 0;
+        uint32_t unit = 0;
+        BankId bank = 0;
+    };
+
+    // Stack frame that a function's prologue sets up, e.g. "pshs y,u" then "leas -4,s". From
+    // the return address down: the saved registers, then the locals, with S pointing at the
+    // last byte allocated. Parts whose prologue instruction hasn't run yet (the PC is before
+    // pushEnd or allocateEnd) aren't on the stack.
+    struct FrameLayout {
+        uint8_t savedRegisters = 0; // pshs postbyte: PC U Y X DP B A CC, bit 7 down to 0
+        uint8_t savedSize = 0;      // Bytes of the saved registers
+        uint16_t localsSize = 0;    // Bytes allocated by leas
+        uint8_t pushEnd = 0;        // Offset from the function start past the pshs, if any
+        uint8_t allocateEnd = 0;    // Offset from the function start past the leas, if any
+    };
+
+    constexpr uint32_t UnknownStackDepth = ~uint32_t{0};
+
+    // Bytes a function has on the stack below its return address, from an offset into its code
+    // up to the offset of the next entry (see Function::firstStackDepth)
+    struct StackDepth {
+        uint32_t offset = 0;
+        uint32_t depth = 0; // UnknownStackDepth where S is loaded from elsewhere ("tfr x,s")
+    };
+
+    // Code range of a function symbol: [start, end). Empty if the end is unknown (see
+    // InputFormat::Assembly).
+    struct Function {
+        uint32_t symbol = 0;
+        uint32_t start = 0;
+        uint32_t end = 0;
+        BankId bank = 0;
+        FrameLayout frame; // Listings only; compiler output has no instructions to analyze
+        // Where the function's stack depth changes, by offset, in stackDepths. None for
+        // compiler output.
+        uint32_t firstStackDepth = 0;
+        uint32_t numStackDepths = 0;
+
+        // Worst-case stack use (see ComputeStackDepths): from the return address of the call
+        // to the function down to the deepest frame of everything it calls
+        uint32_t maxStack = 0;
+        uint32_t deepestCallee = InvalidIndex; // Next function on the deepest path
+        bool recursive = false; // In a call cycle; maxStack counts each function of it once
+        bool incomplete = false; // Calls code without a known frame on some path
+    };
+
+    // jsr, bsr or lbsr in a function's code
+    struct Call {
+        uint32_t caller = 0;            // Index into functions
+        uint32_t address = 0;           // Of the call instruction
+        StrId target = InvalidStrId;    // Label called; InvalidStrId if indirect
+        uint32_t callee = InvalidIndex; // Index into functions, if the target is one
+        BankId bank = 0;
+        // Bytes the caller has on the stack beyond its prologue's frame at the call, e.g. the
+        // arguments it pushed; 0 if S isn't known there
+        uint32_t pushedBytes = 0;
+    };
+
+    // Instruction that addresses a label with extended addressing: "lda _score"
+    struct LabelReference {
+        StrId label = 0;
+        uint32_t address = 0; // Of the instruction
+        BankId bank = 0;
+    };
+
+    // N_SLINE: source line of the instruction at address, in the current N_SOL file
+    struct LineEntry {
+        uint32_t address = 0;
+        StrId file = 0;
+        uint32_t line = 0;
+        BankId bank = 0;
+    };
+
+    // Local variable (N_LSYM) or function static ('V') declared in a block
+    struct Variable {
+        StrId name = 0;
+        TypeId type = InvalidTypeId;
+        int32_t frameOffset = 0;        // Locals: N_LSYM value
+        uint32_t symbol = InvalidIndex; // Function statics: index into symbols
+    };
+
+    // N_LBRAC/N_RBRAC block: [start, end)
+    struct Scope {
+        uint32_t parent = InvalidIndex;   // Enclosing block, or InvalidIndex if outermost
+        uint32_t function = InvalidIndex; // Index into symbols of the enclosing function
+        uint32_t unit = 0;
+        uint32_t start = InvalidAddress;
+        uint32_t end = InvalidAddress;
+        uint32_t firstVariable = 0;
+        uint32_t numVariables = 0;
+    };
+
+    // One loaded listing file
+    struct CompileUnit {
+        StrId name = 0;
+        BankId bank = 0; // Cartridge bank the unit's code and data live in
+        TypeId firstType = 0;
+        uint32_t numTypes = 0;
+    };
+
+    // Flat tables of everything loaded from the listings. Entries refer to each other by index.
+    class DebugInfo {
+    public:
+        StringPool strings;
+        std::vector<CompileUnit> units;
+        std::vector<Type> types;
+        std::vector<StructMember> members;
+        std::vector<Enumerator> enumerators;
+        std::vector<BaseClass> baseClasses;
+        std::vector<Method> methods;
+        std::vector<Symbol> symbols;
+        std::vector<Label> labels;
+        std::vector<Function> functions; // Sorted by start address within each unit
+        std::vector<StackDepth> stackDepths;
+        std::vector<Call> calls;
+        std::vector<LabelReference> extendedReferences;
+        std::vector<LineEntry> lines;
+        std::vector<Variable> variables;
+        std::vector<Scope> scopes; // Parents always precede their children
+
+        // Returns the C-style name of a type, e.g. "int*[4]", "Foo (*)[3]" or "const char*". The
+        // name is formatted on first request and kept in the string pool until Clear() (i.e.
+        // reload).
+        std::string_view TypeName(TypeId id);
+
+        void Clear();
+
+    private:
+        std::string FormatTypeName(TypeId id) const;
+
+        std::vector<StrId> m_typeNames;
+    };
+
+} // namespace stabs
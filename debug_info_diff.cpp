@@ -0,0 +1,358 @@
+#include "debug_info_diff.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "debug_info.h"
+
+namespace stabs {
+    namespace {
+        // FNV-1a
+        struct Hasher {
+            uint64_t value = 14695981039346656037ull;
+
+            void Add(const void* data, size_t size) {
+                auto bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    value ^= bytes[i];
+                    value *= 1099511628211ull;
+                }
+            }
+            void Add(std::string_view s) {
+                Add(s.data(), s.size());
+                Add(uint64_t{s.size()});
+            }
+            void Add(uint64_t v) { Add(&v, sizeof(v)); }
+        };
+
+        struct Entity {
+            DiffEntity kind;
+            std::string key;
+            uint64_t hash;
+            uint32_t index; // Into types or symbols, depending on kind
+        };
+
+        std::string_view BaseName(std::string_view path) {
+            const size_t slash = path.find_last_of("/\\");
+            return slash == std::string_view::npos ? path : path.substr(slash + 1);
+        }
+
+        std::string Hex(BankId bank, uint32_t address) {
+            if (address == InvalidAddress)
+                return "?";
+            char buffer[16];
+            std::snprintf(buffer, sizeof(buffer), "%u:%04X", bank, address);
+            return buffer;
+        }
+
+        std::string Change(const char* what, const std::string& before,
+                           const std::string& after) {
+            return std::string(what) + " " + before + " -> " + after;
+        }
+
+        std::string Change(const char* what, uint64_t before, uint64_t after) {
+            return Change(what, std::to_string(before), std::to_string(after));
+        }
+
+        void Append(std::string& details, const std::string& change) {
+            if (!details.empty())
+                details += ", ";
+            details += change;
+        }
+
+        uint32_t FunctionSize(const Function& f) { return f.end - f.start; }
+
+        // "Base, virtual Other"
+        std::string BaseClassNames(DebugInfo& info, const Type& type) {
+            std::string names;
+            for (uint32_t i = type.firstBase; i < type.firstBase + type.numBases; ++i) {
+                const BaseClass& base = info.baseClasses[i];
+                if (!names.empty())
+                    names += ", ";
+                if (base.isVirtual)
+                    names += "virtual ";
+                names += info.TypeName(base.type);
+            }
+            return names;
+        }
+
+        // "main.lst:" for entities of a compile unit
+        std::string UnitKey(DebugInfo& info, uint32_t unit) {
+            std::string key(BaseName(info.strings.Get(info.units[unit].name)));
+            key += ':';
+            return key;
+        }
+
+        std::vector<Entity> CollectEntities(DebugInfo& info) {
+            std::vector<Entity> entities;
+
+            for (TypeId id = 0; id < info.types.size(); ++id) {
+                const Type& type = info.types[id];
+                if (type.name == 0)
+                    continue;
+                // Declared only ("xsFoo:"); the unit that defines it has the full type
+                if (type.numChildren == 0 && type.numBases == 0 && type.byteSize == 0)
+                    continue;
+
+                Hasher h;
+                DiffEntity kind;
+                if (type.kind == TypeKind::Struct || type.kind == TypeKind::Union) {
+                    h.Add(type.byteSize);
+                    h.Add(BaseClassNames(info, type));
+                    for (uint32_t i = type.first; i < type.first + type.numChildren; ++i) {
+                        const StructMember& m = info.members[i];
+                        h.Add(info.strings.Get(m.name));
+                        h.Add(info.TypeName(m.type));
+                        h.Add(uint64_t{m.bitOffset} << 32 | m.bitSize);
+                    }
+                    kind = DiffEntity::Struct;
+                } else if (type.kind == TypeKind::Enum) {
+                    for (uint32_t i = type.first; i < type.first + type.numChildren; ++i) {
+                        h.Add(info.strings.Get(info.enumerators[i].name));
+                        h.Add(static_cast<uint64_t>(info.enumerators[i].value));
+                    }
+                    kind = DiffEntity::Enum;
+                } else {
+                    continue;
+                }
+                // Tags are only unique within a unit; header types are compared per unit
+                std::string key = UnitKey(info, type.unit);
+                key += info.strings.Get(type.name);
+                entities.push_back({kind, std::move(key), h.value, id});
+            }
+
+            for (auto& function : info.functions) {
+                const Symbol& symbol = info.symbols[function.symbol];
+                Hasher h;
+                h.Add(function.bank);
+                h.Add(function.start);
+                h.Add(FunctionSize(function));
+                const auto index = static_cast<uint32_t>(&function - info.functions.data());
+                std::string key = UnitKey(info, symbol.unit);
+                key += info.strings.Get(symbol.name);
+                entities.push_back({DiffEntity::Function, std::move(key), h.value, index});
+            }
+
+            // Function statics ('V') follow the function symbol that declares them
+            uint32_t function = InvalidIndex;
+            for (uint32_t i = 0; i < info.symbols.size(); ++i) {
+                const Symbol& symbol = info.symbols[i];
+                if (symbol.kind == SymbolKind::Function) {
+                    function = i;
+                    continue;
+                }
+                Hasher h;
+                h.Add(symbol.bank);
+                h.Add(symbol.address);
+                h.Add(info.TypeName(symbol.type));
+                std::string key = UnitKey(info, symbol.unit);
+                if (symbol.kind == SymbolKind::FunctionStatic && function != InvalidIndex &&
+                    info.symbols[function].unit == symbol.unit) {
+                    key += info.strings.Get(info.symbols[function].name);
+                    key += ':';
+                }
+                key += info.strings.Get(symbol.name);
+                entities.push_back({DiffEntity::Global, std::move(key), h.value, i});
+            }
+
+            // Keys that still collide (e.g. a unit loaded twice) are numbered in table order,
+            // "main.lst:Foo#2", so that every entity is compared and reported
+            auto less = [](const Entity& a, const Entity& b) {
+                return a.kind != b.kind ? a.kind < b.kind : a.key < b.key;
+            };
+            std::stable_sort(entities.begin(), entities.end(), less);
+            bool numbered = false;
+            for (size_t i = 1, first = 0; i < entities.size(); ++i) {
+                if (entities[i].kind != entities[first].kind ||
+                    entities[i].key != entities[first].key) {
+                    first = i;
+                    continue;
+                }
+                entities[i].key += '#' + std::to_string(i - first + 1);
+                numbered = true;
+            }
+            if (numbered)
+                std::stable_sort(entities.begin(), entities.end(), less);
+            return entities;
+        }
+
+        // Members or enumerators of an aggregate by name, so that comparing two takes one
+        // pass over each
+        template <typename RECORD>
+        class NameIndex {
+        public:
+            NameIndex(const DebugInfo& info, const std::vector<RECORD>& records, const Type& type) {
+                m_records.reserve(type.numChildren);
+                for (uint32_t i = type.first; i < type.first + type.numChildren; ++i)
+                    m_records.try_emplace(info.strings.Get(records[i].name), &records[i]);
+            }
+
+            const RECORD* Find(std::string_view name) const {
+                auto it = m_records.find(name);
+                return it != m_records.end() ? it->second : nullptr;
+            }
+
+        private:
+            std::unordered_map<std::string_view, const RECORD*> m_records; // Views of the pool
+        };
+
+        std::string DescribeStruct(DebugInfo& before, const Type& a, DebugInfo& after,
+                                   const Type& b) {
+            std::string details;
+            if (a.byteSize != b.byteSize)
+                Append(details, Change("size", a.byteSize, b.byteSize));
+            const std::string basesA = BaseClassNames(before, a);
+            const std::string basesB = BaseClassNames(after, b);
+            if (basesA != basesB)
+                Append(details, Change("bases", basesA, basesB));
+
+            const NameIndex membersA(before, before.members, a);
+            const NameIndex membersB(after, after.members, b);
+            for (uint32_t i = a.first; i < a.first + a.numChildren; ++i) {
+                const StructMember& ma = before.members[i];
+                const std::string name(before.strings.Get(ma.name));
+                const StructMember* mb = membersB.Find(name);
+                if (!mb) {
+                    Append(details, "-" + name);
+                    continue;
+                }
+                if (ma.bitOffset != mb->bitOffset)
+                    Append(details,
+                           name + ": " + Change("bit offset", ma.bitOffset, mb->bitOffset));
+                if (ma.bitSize != mb->bitSize)
+                    Append(details, name + ": " + Change("bit size", ma.bitSize, mb->bitSize));
+                const std::string typeA(before.TypeName(ma.type));
+                const std::string typeB(after.TypeName(mb->type));
+                if (typeA != typeB)
+                    Append(details, name + ": " + Change("type", typeA, typeB));
+            }
+            for (uint32_t i = b.first; i < b.first + b.numChildren; ++i) {
+                const std::string_view name = after.strings.Get(after.members[i].name);
+                if (!membersA.Find(name))
+                    Append(details, "+" + std::string(name));
+            }
+            return details;
+        }
+
+        std::string DescribeEnum(DebugInfo& before, const Type& a, DebugInfo& after,
+                                 const Type& b) {
+            std::string details;
+            const NameIndex valuesA(before, before.enumerators, a);
+            const NameIndex valuesB(after, after.enumerators, b);
+            for (uint32_t i = a.first; i < a.first + a.numChildren; ++i) {
+                const Enumerator& ea = before.enumerators[i];
+                const std::string name(before.strings.Get(ea.name));
+                const Enumerator* eb = valuesB.Find(name);
+                if (!eb)
+                    Append(details, "-" + name);
+                else if (ea.value != eb->value)
+                    Append(details, name + " " + std::to_string(ea.value) + " -> " +
+                                        std::to_string(eb->value));
+            }
+            for (uint32_t i = b.first; i < b.first + b.numChildren; ++i) {
+                const std::string_view name = after.strings.Get(after.enumerators[i].name);
+                if (!valuesA.Find(name))
+                    Append(details, "+" + std::string(name));
+            }
+            return details;
+        }
+
+        std::string Describe(DebugInfo& before, const Entity& a, DebugInfo& after,
+                             const Entity& b) {
+            switch (a.kind) {
+            case DiffEntity::Struct:
+                return DescribeStruct(before, before.types[a.index], after, after.types[b.index]);
+            case DiffEntity::Enum:
+                return DescribeEnum(before, before.types[a.index], after, after.types[b.index]);
+            case DiffEntity::Function: {
+                const Function& fa = before.functions[a.index];
+                const Function& fb = after.functions[b.index];
+                std::string details;
+                if (fa.bank != fb.bank || fa.start != fb.start)
+                    Append(details,
+                           Change("address", Hex(fa.bank, fa.start), Hex(fb.bank, fb.start)));
+                if (FunctionSize(fa) != FunctionSize(fb))
+                    Append(details, Change("size", FunctionSize(fa), FunctionSize(fb)));
+                return details;
+            }
+            case DiffEntity::Global: {
+                const Symbol& sa = before.symbols[a.index];
+                const Symbol& sb = after.symbols[b.index];
+                std::string details;
+                if (sa.bank != sb.bank || sa.address != sb.address)
+                    Append(details, Change("address", Hex(sa.bank, sa.address),
+                                           Hex(sb.bank, sb.address)));
+                const std::string typeA(before.TypeName(sa.type));
+                const std::string typeB(after.TypeName(sb.type));
+                if (typeA != typeB)
+                    Append(details, Change("type", typeA, typeB));
+                return details;
+            }
+            }
+            return {};
+        }
+
+    } // namespace
+
+    std::vector<DiffEntry> Diff(DebugInfo& before, DebugInfo& after) {
+        const std::vector<Entity> a = CollectEntities(before);
+        const std::vector<Entity> b = CollectEntities(after);
+
+        std::vector<DiffEntry> result;
+        auto ia = a.begin();
+        auto ib = b.begin();
+        while (ia != a.end() || ib != b.end()) {
+            const bool takeA = ib == b.end() ||
+                               (ia != a.end() && (ia->kind != ib->kind ? ia->kind < ib->kind
+                                                                       : ia->key < ib->key));
+            const bool takeB = ia == a.end() ||
+                               (ib != b.end() && (ia->kind != ib->kind ? ib->kind < ia->kind
+                                                                       : ib->key < ia->key));
+            if (takeA) {
+                result.push_back({ia->kind, DiffChange::Removed, ia->key, {}});
+                ++ia;
+            } else if (takeB) {
+                result.push_back({ib->kind, DiffChange::Added, ib->key, {}});
+                ++ib;
+            } else {
+                if (ia->hash != ib->hash) {
+                    result.push_back({ia->kind, DiffChange::Changed, ia->key,
+                                      Describe(before, *ia, after, *ib)});
+                }
+                ++ia;
+                ++ib;
+            }
+        }
+        return result;
+    }
+
+    const char* ToString(DiffEntity entity) {
+        switch (entity) {
+        case DiffEntity::Struct:
+            return "struct";
+        case DiffEntity::Enum:
+            return "enum";
+        case DiffEntity::Function:
+            return "function";
+        case DiffEntity::Global:
+            return "global";
+        }
+        return "";
+    }
+
+    const char* ToString(DiffChange change) {
+        switch (change) {
+        case DiffChange::Added:
+            return "added";
+        case DiffChange::Removed:
+            return "removed";
+        case DiffChange::Changed:
+            return "changed";
+        }
+        return "";
+    }
+
+} // namespace stabs
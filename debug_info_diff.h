@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stabs {
+    class DebugInfo;
+
+    enum class DiffEntity : uint8_t { Struct, Enum, Function, Global };
+    enum class DiffChange : uint8_t { Added, Removed, Changed };
+
+    struct DiffEntry {
+        DiffEntity entity;
+        DiffChange change;
+        std::string name;
+        std::string details; // What changed, e.g. "size 14 -> 16"
+    };
+
+    // Compares two builds. Each entity is reduced to a structural hash, both sides are sorted by
+    // name and then walked in a single merge pass; details are only computed for changed entries.
+    // Every name is qualified by its compile unit ("main.lst:var_init"), function statics also
+    // by their function ("main.lst:main:count"). Names that still collide are numbered in table
+    // order ("main.lst:Foo#2") rather than dropped.
+    std::vector<DiffEntry> Diff(DebugInfo& before, DebugInfo& after);
+
+    const char* ToString(DiffEntity entity);
+    const char* ToString(DiffChange change);
+
+} // namespace stabs
@@ -0,0 +1,73 @@
+#include "direct_page.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace stabs {
+    namespace {
+        constexpr uint32_t DirectPageSize = 0x100;
+        constexpr uint32_t CyclesSavedPerAccess = 1;
+    } // namespace
+
+    std::vector<DirectPageCandidate> AdviseDirectPage(const DebugInfo& info,
+                                                      const std::vector<uint32_t>& accessCounts,
+                                                      const DirectPageOptions& options) {
+        const uint32_t dpEnd = options.directPage + DirectPageSize;
+        auto inDirectPage = [&](uint32_t address) {
+            return address >= options.directPage && address < dpEnd;
+        };
+
+        std::unordered_map<StrId, uint32_t> references;
+        for (auto& reference : info.extendedReferences) {
+            if (reference.bank == options.bank)
+                ++references[reference.label];
+        }
+
+        uint32_t used = options.reservedBytes;
+        std::vector<DirectPageCandidate> candidates;
+        for (uint32_t i = 0; i < info.symbols.size(); ++i) {
+            const Symbol& symbol = info.symbols[i];
+            if (symbol.kind == SymbolKind::Function || symbol.bank != options.bank ||
+                symbol.address == InvalidAddress || symbol.type >= info.types.size())
+                continue;
+            const uint32_t size = info.types[symbol.type].byteSize;
+            if (inDirectPage(symbol.address)) {
+                used += size;
+                continue;
+            }
+            if (symbol.address < options.ramStart || symbol.address + size > options.ramEnd)
+                continue;
+            auto it = references.find(symbol.label);
+            if (it == references.end() || size == 0 || size > DirectPageSize)
+                continue;
+
+            DirectPageCandidate candidate;
+            candidate.symbol = i;
+            candidate.size = size;
+            candidate.extendedInstructions = it->second;
+            if (accessCounts.empty()) {
+                candidate.accesses = it->second;
+            } else {
+                for (uint32_t a = symbol.address;
+                     a < symbol.address + size && a < accessCounts.size(); ++a)
+                    candidate.accesses += accessCounts[a];
+            }
+            candidate.cyclesSaved = candidate.accesses * CyclesSavedPerAccess;
+            if (candidate.cyclesSaved != 0)
+                candidates.push_back(candidate);
+        }
+
+        // Savings per byte, then greedily into the free bytes
+        std::sort(candidates.begin(), candidates.end(), [](auto& a, auto& b) {
+            return a.cyclesSaved * b.size > b.cyclesSaved * a.size;
+        });
+        uint32_t free = used < DirectPageSize ? DirectPageSize - used : 0;
+        for (auto& candidate : candidates) {
+            candidate.fits = candidate.size <= free;
+            if (candidate.fits)
+                free -= candidate.size;
+        }
+        return candidates;
+    }
+
+} // namespace stabs
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    struct DirectPageOptions {
+        BankId bank = 0;
+        uint32_t directPage = 0xC800; // Address the DP register selects (DP = $C8)
+        // Only variables in RAM can move; the Vectrex has $C800-$CBFF
+        uint32_t ramStart = 0xC800;
+        uint32_t ramEnd = 0xCC00;
+        // Bytes of the direct page used by other code, e.g. the BIOS's variables
+        uint32_t reservedBytes = 0;
+    };
+
+    struct DirectPageCandidate {
+        uint32_t symbol = 0; // Index into DebugInfo::symbols
+        uint32_t size = 0;
+        uint64_t accesses = 0;             // Accesses to its bytes
+        uint32_t extendedInstructions = 0; // Instructions addressing it with extended addressing
+        uint64_t cyclesSaved = 0;          // Estimated, if moved into the direct page
+        bool fits = false; // Fits in the free direct page bytes when taken in rank order
+    };
+
+    // Ranks the RAM variables outside the direct page (globals and statics, sized by their
+    // types) by the cycles moving each into it would save per byte it takes. A direct access
+    // is one cycle shorter than an extended one (and its instruction one byte shorter), so a
+    // variable saves a cycle per access if its code addresses it directly (extended references
+    // from the listings' operands). Variables no instruction addresses that way aren't listed.
+    //
+    // accessCounts holds the emulator's count of accesses to each address (64K entries). If it
+    // is empty, each extended instruction counts as one access, which ranks by code size.
+    std::vector<DirectPageCandidate> AdviseDirectPage(const DebugInfo& info,
+                                                      const std::vector<uint32_t>& accessCounts,
+                                                      const DirectPageOptions& options = {});
+
+} // namespace stabs
@@ -0,0 +1,151 @@
+#include "footprint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+#include "buffered_writer.h"
+
+namespace stabs {
+    namespace {
+        // Entries keyed by name, in the order first seen
+        class Breakdown {
+        public:
+            FootprintEntry& operator[](std::string_view name) {
+                auto [it, added] = m_index.try_emplace(name, m_entries.size());
+                if (added)
+                    m_entries.push_back({std::string(name)});
+                return m_entries[it->second];
+            }
+
+            std::vector<FootprintEntry> Sorted() {
+                std::sort(m_entries.begin(), m_entries.end(), [](auto& a, auto& b) {
+                    return a.ram != b.ram ? a.ram > b.ram : a.rom > b.rom;
+                });
+                return std::move(m_entries);
+            }
+
+        private:
+            std::unordered_map<std::string_view, size_t> m_index; // Views of the string pool
+            std::vector<FootprintEntry> m_entries;
+        };
+
+        void Add(FootprintEntry& entry, uint64_t ram, uint64_t rom) {
+            entry.ram += ram;
+            entry.rom += rom;
+            ++entry.symbols;
+        }
+
+        void WriteEntriesText(const char* title, const std::vector<FootprintEntry>& entries,
+                              BufferedWriter& out) {
+            out.Write("\n");
+            out.Write(title);
+            out.Write("\n     RAM      ROM  Symbols  Name\n");
+            for (auto& entry : entries) {
+                char line[40];
+                std::snprintf(line, sizeof(line), "%8llu %8llu %8u  ",
+                              static_cast<unsigned long long>(entry.ram),
+                              static_cast<unsigned long long>(entry.rom), entry.symbols);
+                out.Write(line);
+                out.Write(entry.name);
+                out.Put('\n');
+            }
+        }
+
+        void WriteEntriesJson(const char* key, const std::vector<FootprintEntry>& entries,
+                              BufferedWriter& out) {
+            out.Write(",\n  \"");
+            out.Write(key);
+            out.Write("\": [");
+            for (size_t i = 0; i < entries.size(); ++i) {
+                out.Write(i == 0 ? "\n    {\"name\": " : ",\n    {\"name\": ");
+                out.WriteJsonString(entries[i].name);
+                out.Write(", \"ram\": ");
+                out.WriteUnsigned(entries[i].ram);
+                out.Write(", \"rom\": ");
+                out.WriteUnsigned(entries[i].rom);
+                out.Write(", \"symbols\": ");
+                out.WriteUnsigned(entries[i].symbols);
+                out.Put('}');
+            }
+            out.Write(entries.empty() ? "]" : "\n  ]");
+        }
+    } // namespace
+
+    Footprint ComputeFootprint(DebugInfo& info, const FootprintOptions& options) {
+        Footprint footprint;
+        Breakdown units, files, types;
+
+        auto unitName = [&](uint32_t unit) { return info.strings.Get(info.units[unit].name); };
+        // Symbols declared in the main source file have no N_SOL file; use the unit
+        auto fileName = [&](const Symbol& symbol) {
+            return symbol.file != 0 ? info.strings.Get(symbol.file) : unitName(symbol.unit);
+        };
+
+        for (auto& symbol : info.symbols) {
+            if (symbol.kind == SymbolKind::Function || symbol.address == InvalidAddress ||
+                symbol.type >= info.types.size())
+                continue;
+            const uint64_t size = info.types[symbol.type].byteSize;
+            uint64_t ram = 0, rom = 0;
+            switch (symbol.section) {
+            case SymbolSection::Text:
+                rom = size;
+                break;
+            case SymbolSection::Data:
+                ram = rom = size;
+                break;
+            case SymbolSection::Bss:
+                ram = size;
+                break;
+            case SymbolSection::Unknown:
+                if (symbol.address >= options.ramStart && symbol.address < options.ramEnd)
+                    ram = size;
+                else
+                    rom = size;
+                break;
+            }
+            footprint.ram += ram;
+            footprint.rom += rom;
+            Add(units[unitName(symbol.unit)], ram, rom);
+            Add(files[fileName(symbol)], ram, rom);
+            Add(types[info.TypeName(symbol.type)], ram, rom);
+        }
+
+        for (auto& function : info.functions) {
+            const Symbol& symbol = info.symbols[function.symbol];
+            const uint64_t size = function.end - function.start;
+            footprint.rom += size;
+            Add(units[unitName(symbol.unit)], 0, size);
+            Add(files[fileName(symbol)], 0, size);
+        }
+
+        footprint.units = units.Sorted();
+        footprint.files = files.Sorted();
+        footprint.types = types.Sorted();
+        return footprint;
+    }
+
+    void WriteFootprintText(const Footprint& footprint, BufferedWriter& out) {
+        out.Write("RAM ");
+        out.WriteUnsigned(footprint.ram);
+        out.Write(" bytes, ROM ");
+        out.WriteUnsigned(footprint.rom);
+        out.Write(" bytes\n");
+        WriteEntriesText("By unit", footprint.units, out);
+        WriteEntriesText("By file", footprint.files, out);
+        WriteEntriesText("By type", footprint.types, out);
+    }
+
+    void WriteFootprintJson(const Footprint& footprint, BufferedWriter& out) {
+        out.Write("{\n  \"ram\": ");
+        out.WriteUnsigned(footprint.ram);
+        out.Write(",\n  \"rom\": ");
+        out.WriteUnsigned(footprint.rom);
+        WriteEntriesJson("units", footprint.units, out);
+        WriteEntriesJson("files", footprint.files, out);
+        WriteEntriesJson("types", footprint.types, out);
+        out.Write("\n}\n");
+    }
+
+} // namespace stabs
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    class BufferedWriter;
+
+    struct FootprintOptions {
+        // Globals (N_GSYM) carry no section; those in RAM are told apart by address. The
+        // Vectrex has $C800-$CBFF.
+        uint32_t ramStart = 0xC800;
+        uint32_t ramEnd = 0xCC00;
+    };
+
+    struct FootprintEntry {
+        std::string name;
+        uint64_t ram = 0;
+        uint64_t rom = 0;
+        uint32_t symbols = 0;
+    };
+
+    // RAM and ROM taken by the data symbols (sized by their types) and the functions (code
+    // ranges). Initialized data counts in both: the variable, and its initializer in ROM.
+    struct Footprint {
+        uint64_t ram = 0;
+        uint64_t rom = 0;
+        // Each sorted by RAM, then ROM, largest first
+        std::vector<FootprintEntry> units;
+        std::vector<FootprintEntry> files; // N_SOL files the symbols are declared in
+        std::vector<FootprintEntry> types; // Data only
+    };
+
+    // One pass over the symbols and one over the functions
+    Footprint ComputeFootprint(DebugInfo& info, const FootprintOptions& options = {});
+
+    void WriteFootprintText(const Footprint& footprint, BufferedWriter& out);
+    void WriteFootprintJson(const Footprint& footprint, BufferedWriter& out);
+
+} // namespace stabs
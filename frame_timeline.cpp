@@ -0,0 +1,136 @@
+#include "frame_timeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+
+#include "linker_map.h"
+
+namespace stabs {
+
+    FrameTimeline::FrameTimeline(const DebugInfo& info, const AddressIndex& index,
+                                 uint32_t capacity)
+        : m_info(info)
+        , m_index(index)
+        , m_capacity(std::max(capacity, 1u) + 1)
+        , m_columns(static_cast<uint32_t>(info.functions.size()) + 1)
+        , m_frameNumbers(m_capacity, 0)
+        , m_frameCycles(m_capacity, 0)
+        , m_cycles(size_t{m_capacity} * m_columns, 0)
+        , m_stack(1, UnknownFunction) {}
+
+    bool FrameTimeline::SetFrameMarker(std::string_view symbol, const LinkerMap* linkerMap) {
+        const std::string label = "_" + std::string(symbol);
+        for (auto name : {symbol, std::string_view(label)}) {
+            const StrId id = m_info.strings.Find(name);
+            if (id == InvalidStrId)
+                continue;
+            for (auto& s : m_info.symbols) {
+                if ((s.name == id || s.label == id) && s.address != InvalidAddress) {
+                    SetFrameMarker(s.bank, s.address);
+                    return true;
+                }
+            }
+            for (auto& l : m_info.labels) {
+                if (l.name == id) {
+                    SetFrameMarker(l.bank, l.address);
+                    return true;
+                }
+            }
+        }
+        if (linkerMap) {
+            for (auto name : {symbol, std::string_view(label)}) {
+                if (const uint32_t address = linkerMap->Find(name); address != InvalidAddress) {
+                    SetFrameMarker(0, address);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void FrameTimeline::SetFrameMarker(BankId bank, uint32_t address) {
+        m_markerBank = bank;
+        m_markerAddress = address;
+    }
+
+    uint32_t FrameTimeline::FunctionAt(BankId bank, uint32_t address) const {
+        const Function* function = m_index.FindFunction(bank, address);
+        return function ? static_cast<uint32_t>(function - m_info.functions.data())
+                        : UnknownFunction;
+    }
+
+    // Cycles since the last event belong to the function on top of the shadow stack
+    void FrameTimeline::Charge(uint64_t cycles) {
+        if (m_started) {
+            const auto elapsed = static_cast<uint32_t>(cycles - m_lastCycles);
+            m_cycles[m_current * m_columns + Column(m_stack.back())] += elapsed;
+            m_frameCycles[m_current] += elapsed;
+        }
+        m_started = true;
+        m_lastCycles = cycles;
+    }
+
+    void FrameTimeline::EndFrame() {
+        m_frameNumbers[m_current] = m_frameNumber++;
+        m_current = (m_current + 1) % m_capacity;
+        m_numFrames = std::min<size_t>(m_numFrames + 1, m_capacity - 1);
+        m_frameCycles[m_current] = 0;
+        std::fill_n(m_cycles.begin() + m_current * m_columns, m_columns, 0);
+    }
+
+    void FrameTimeline::OnCall(BankId bank, uint32_t target, uint64_t cycles) {
+        Charge(cycles);
+        if (bank == m_markerBank && target == m_markerAddress)
+            EndFrame();
+        m_stack.push_back(FunctionAt(bank, target));
+    }
+
+    void FrameTimeline::OnReturn(uint64_t cycles) {
+        Charge(cycles);
+        if (m_stack.size() > 1)
+            m_stack.pop_back();
+    }
+
+    std::vector<size_t> FrameTimeline::WorstFrames(double fraction) const {
+        std::vector<size_t> frames(m_numFrames);
+        std::iota(frames.begin(), frames.end(), size_t{0});
+        const auto wanted = static_cast<size_t>(std::ceil(m_numFrames * fraction));
+        const size_t count = std::min(m_numFrames, std::max<size_t>(1, wanted));
+        std::partial_sort(frames.begin(), frames.begin() + count, frames.end(),
+                          [&](size_t a, size_t b) { return FrameCycles(a) > FrameCycles(b); });
+        frames.resize(count);
+        return frames;
+    }
+
+    std::vector<FrameTimeline::Contributor>
+    FrameTimeline::SpikeContributors(const std::vector<size_t>& frames) const {
+        std::vector<Contributor> contributors;
+        if (frames.empty() || m_numFrames == 0)
+            return contributors;
+
+        std::vector<uint64_t> all(m_columns, 0), spikes(m_columns, 0);
+        for (size_t frame = 0; frame < m_numFrames; ++frame) {
+            const uint32_t* row = &m_cycles[Slot(frame) * m_columns];
+            for (uint32_t c = 0; c < m_columns; ++c)
+                all[c] += row[c];
+        }
+        for (size_t frame : frames) {
+            const uint32_t* row = &m_cycles[Slot(frame) * m_columns];
+            for (uint32_t c = 0; c < m_columns; ++c)
+                spikes[c] += row[c];
+        }
+
+        for (uint32_t c = 0; c < m_columns; ++c) {
+            const double excess = static_cast<double>(spikes[c]) / frames.size() -
+                                  static_cast<double>(all[c]) / m_numFrames;
+            if (excess > 0)
+                contributors.push_back({c == m_columns - 1 ? UnknownFunction : c, excess});
+        }
+        std::sort(contributors.begin(), contributors.end(),
+                  [](auto& a, auto& b) { return a.excessCycles > b.excessCycles; });
+        return contributors;
+    }
+
+} // namespace stabs
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "address_index.h"
+#include "debug_info.h"
+
+namespace stabs {
+
+    class LinkerMap;
+
+    // Per video frame cycle totals of every function, for finding what causes frame spikes. The
+    // emulator reports calls and returns with its cycle counter (as for CallProfiler); a call
+    // to the frame marker (e.g. the BIOS's Wait_Recal) ends the current frame. The last
+    // capacity frames are kept in a ring buffer laid out as arrays of columns: frame numbers,
+    // frame totals, and a row of exclusive cycles per function for each frame.
+    //
+    // Cycles outside any known function, including before the first call, go to the
+    // UnknownFunction column.
+    class FrameTimeline {
+    public:
+        static constexpr uint32_t UnknownFunction = InvalidIndex;
+
+        FrameTimeline(const DebugInfo& info, const AddressIndex& index, uint32_t capacity = 1024);
+
+        // Looks the marker up among the symbols and labels (also with a leading '_'), then in
+        // the linker map if given. Returns false if it isn't found.
+        bool SetFrameMarker(std::string_view symbol, const LinkerMap* linkerMap = nullptr);
+        void SetFrameMarker(BankId bank, uint32_t address);
+
+        void OnCall(BankId bank, uint32_t target, uint64_t cycles);
+        void OnReturn(uint64_t cycles);
+
+        // Completed frames in the buffer; frame 0 is the oldest
+        size_t NumFrames() const { return m_numFrames; }
+        uint64_t FrameNumber(size_t frame) const { return m_frameNumbers[Slot(frame)]; }
+        uint32_t FrameCycles(size_t frame) const { return m_frameCycles[Slot(frame)]; }
+        uint32_t FunctionCycles(size_t frame, uint32_t function) const {
+            return m_cycles[Slot(frame) * m_columns + Column(function)];
+        }
+
+        // The slowest fraction of the buffered frames (at least one), slowest first
+        std::vector<size_t> WorstFrames(double fraction = 0.01) const;
+
+        struct Contributor {
+            uint32_t function;
+            double excessCycles; // Mean over the frames given, less the mean over all frames
+        };
+
+        // Functions that take longer in the given frames than on average, most excess first
+        std::vector<Contributor> SpikeContributors(const std::vector<size_t>& frames) const;
+
+    private:
+        size_t Slot(size_t frame) const {
+            return (m_current + m_capacity - m_numFrames + frame) % m_capacity;
+        }
+        uint32_t Column(uint32_t function) const {
+            return function == UnknownFunction ? m_columns - 1 : function;
+        }
+        uint32_t FunctionAt(BankId bank, uint32_t address) const;
+        void Charge(uint64_t cycles);
+        void EndFrame();
+
+        const DebugInfo& m_info;
+        const AddressIndex& m_index;
+        const uint32_t m_capacity; // Slots: the frames kept, and the frame in progress
+        const uint32_t m_columns; // One per function, then UnknownFunction
+
+        // Ring buffer: m_current is the slot of the frame in progress
+        std::vector<uint64_t> m_frameNumbers;
+        std::vector<uint32_t> m_frameCycles;
+        std::vector<uint32_t> m_cycles; // m_columns per frame
+        size_t m_current = 0;
+        size_t m_numFrames = 0;
+        uint64_t m_frameNumber = 0;
+
+        BankId m_markerBank = 0;
+        uint32_t m_markerAddress = InvalidAddress;
+        std::vector<uint32_t> m_stack; // Functions of the shadow call stack
+        uint64_t m_lastCycles = 0;
+        bool m_started = false;
+    };
+
+} // namespace stabs
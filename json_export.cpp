@@ -0,0 +1,335 @@
+#include "json_export.h"
+
+#include <unordered_map>
+
+#include "buffered_writer.h"
+
+namespace stabs {
+    namespace {
+        const char* ToString(TypeKind kind) {
+            switch (kind) {
+            case TypeKind::Unknown:
+                return "unknown";
+            case TypeKind::Base:
+                return "base";
+            case TypeKind::Pointer:
+                return "pointer";
+            case TypeKind::Array:
+                return "array";
+            case TypeKind::Enum:
+                return "enum";
+            case TypeKind::Struct:
+                return "struct";
+            case TypeKind::Union:
+                return "union";
+            case TypeKind::Function:
+                return "function";
+            case TypeKind::Const:
+                return "const";
+            case TypeKind::Volatile:
+                return "volatile";
+            case TypeKind::Typedef:
+                return "typedef";
+            }
+            return "";
+        }
+
+        const char* ToString(SymbolKind kind) {
+            switch (kind) {
+            case SymbolKind::Function:
+                return "function";
+            case SymbolKind::FileStatic:
+                return "fileStatic";
+            case SymbolKind::FunctionStatic:
+                return "functionStatic";
+            case SymbolKind::Global:
+                return "global";
+            }
+            return "";
+        }
+
+        const char* ToString(SymbolSection section) {
+            switch (section) {
+            case SymbolSection::Unknown:
+                return "unknown";
+            case SymbolSection::Text:
+                return "text";
+            case SymbolSection::Data:
+                return "data";
+            case SymbolSection::Bss:
+                return "bss";
+            }
+            return "";
+        }
+
+        const char* ToString(Access access) {
+            switch (access) {
+            case Access::Private:
+                return "private";
+            case Access::Protected:
+                return "protected";
+            case Access::Public:
+                return "public";
+            }
+            return "";
+        }
+
+        // Writes the members of one object, comma separated. Index writes null for InvalidIndex,
+        // which is also InvalidTypeId and InvalidAddress.
+        class ObjectWriter {
+        public:
+            explicit ObjectWriter(BufferedWriter& out)
+                : m_out(out) {
+                m_out.Put('{');
+            }
+            ~ObjectWriter() { m_out.Put('}'); }
+
+            void String(const char* key, std::string_view value) {
+                Key(key);
+                m_out.WriteJsonString(value);
+            }
+            void Name(const char* key, const char* value) {
+                Key(key);
+                m_out.Put('"');
+                m_out.Write(value);
+                m_out.Put('"');
+            }
+            void Unsigned(const char* key, uint32_t value) {
+                Key(key);
+                m_out.WriteUnsigned(value);
+            }
+            void Signed(const char* key, int64_t value) {
+                Key(key);
+                m_out.WriteSigned(value);
+            }
+            void Index(const char* key, uint32_t value) {
+                Key(key);
+                if (value == InvalidIndex)
+                    m_out.Write("null");
+                else
+                    m_out.WriteUnsigned(value);
+            }
+            void Bool(const char* key, bool value) {
+                Key(key);
+                m_out.Write(value ? "true" : "false");
+            }
+            // Starts an array value; the caller writes the elements and the closing ']'
+            void Array(const char* key) {
+                Key(key);
+                m_out.Put('[');
+            }
+
+        private:
+            void Key(const char* key) {
+                if (!m_first)
+                    m_out.Write(", ");
+                m_first = false;
+                m_out.Put('"');
+                m_out.Write(key);
+                m_out.Write("\": ");
+            }
+
+            BufferedWriter& m_out;
+            bool m_first = true;
+        };
+
+        void WriteMembers(const DebugInfo& info, const Type& type, BufferedWriter& out) {
+            for (uint32_t i = type.first; i < type.first + type.numChildren; ++i) {
+                const StructMember& member = info.members[i];
+                if (i != type.first)
+                    out.Write(", ");
+                ObjectWriter object(out);
+                object.String("name", info.strings.Get(member.name));
+                object.Index("type", member.type);
+                object.Unsigned("bitOffset", member.bitOffset);
+                object.Unsigned("bitSize", member.bitSize);
+            }
+        }
+
+        void WriteEnumerators(const DebugInfo& info, const Type& type, BufferedWriter& out) {
+            for (uint32_t i = type.first; i < type.first + type.numChildren; ++i) {
+                const Enumerator& enumerator = info.enumerators[i];
+                if (i != type.first)
+                    out.Write(", ");
+                ObjectWriter object(out);
+                object.String("name", info.strings.Get(enumerator.name));
+                object.Signed("value", enumerator.value);
+            }
+        }
+
+        void WriteBases(const DebugInfo& info, const Type& type, BufferedWriter& out) {
+            for (uint32_t i = type.firstBase; i < type.firstBase + type.numBases; ++i) {
+                const BaseClass& base = info.baseClasses[i];
+                if (i != type.firstBase)
+                    out.Write(", ");
+                ObjectWriter object(out);
+                object.Index("type", base.type);
+                object.Unsigned("bitOffset", base.bitOffset);
+                object.Name("access", ToString(base.access));
+                object.Bool("virtual", base.isVirtual);
+            }
+        }
+
+        void WriteMethods(const DebugInfo& info, const Type& type, BufferedWriter& out) {
+            for (uint32_t i = type.firstMethod; i < type.firstMethod + type.numMethods; ++i) {
+                const Method& method = info.methods[i];
+                if (i != type.firstMethod)
+                    out.Write(", ");
+                ObjectWriter object(out);
+                object.String("name", info.strings.Get(method.name));
+                object.String("physName", info.strings.Get(method.physName));
+                object.Index("type", method.type);
+                object.Name("access", ToString(method.access));
+                object.Bool("virtual", method.isVirtual);
+                object.Bool("static", method.isStatic);
+            }
+        }
+
+        void WriteType(const DebugInfo& info, const Type& type, BufferedWriter& out) {
+            ObjectWriter object(out);
+            object.Name("kind", ToString(type.kind));
+            object.String("name", info.strings.Get(type.name));
+            object.Unsigned("size", type.byteSize);
+            object.Index("target", type.target);
+            if (type.kind == TypeKind::Array)
+                object.Unsigned("count", type.count);
+            object.Unsigned("unit", type.unit);
+            object.Signed("stabsId", type.stabsId);
+
+            if (type.kind == TypeKind::Struct || type.kind == TypeKind::Union) {
+                object.Array("members");
+                WriteMembers(info, type, out);
+                out.Put(']');
+                object.Array("bases");
+                WriteBases(info, type, out);
+                out.Put(']');
+                object.Array("methods");
+                WriteMethods(info, type, out);
+                out.Put(']');
+            } else if (type.kind == TypeKind::Enum) {
+                object.Array("enumerators");
+                WriteEnumerators(info, type, out);
+                out.Put(']');
+            }
+        }
+
+        void WriteSymbol(const DebugInfo& info, const Symbol& symbol, BufferedWriter& out) {
+            ObjectWriter object(out);
+            object.String("name", info.strings.Get(symbol.name));
+            object.String("label", info.strings.Get(symbol.label));
+            object.String("file", info.strings.Get(symbol.file));
+            object.Name("kind", ToString(symbol.kind));
+            object.Name("section", ToString(symbol.section));
+            object.Index("type", symbol.type);
+            object.Index("address", symbol.address);
+            object.Unsigned("bank", symbol.bank);
+            object.Unsigned("unit", symbol.unit);
+        }
+
+        void WriteScope(const DebugInfo& info, const Scope& scope, BufferedWriter& out) {
+            ObjectWriter object(out);
+            object.Index("parent", scope.parent);
+            object.Index("function", scope.function);
+            object.Unsigned("unit", scope.unit);
+            object.Index("start", scope.start);
+            object.Index("end", scope.end);
+            object.Array("variables");
+            const uint32_t first = scope.firstVariable;
+            for (uint32_t i = first; i < first + scope.numVariables; ++i) {
+                const Variable& variable = info.variables[i];
+                if (i != first)
+                    out.Write(", ");
+                ObjectWriter element(out);
+                element.String("name", info.strings.Get(variable.name));
+                element.Index("type", variable.type);
+                if (variable.symbol == InvalidIndex)
+                    element.Signed("frameOffset", variable.frameOffset);
+                else
+                    element.Unsigned("symbol", variable.symbol);
+            }
+            out.Put(']');
+        }
+
+        // Opens the next element of a top-level array, one per line
+        void NextElement(size_t i, BufferedWriter& out) {
+            out.Write(i == 0 ? "\n    " : ",\n    ");
+        }
+        void CloseArray(size_t size, BufferedWriter& out) {
+            out.Write(size == 0 ? "]" : "\n  ]");
+        }
+    } // namespace
+
+    void WriteDebugInfoJson(const DebugInfo& info, BufferedWriter& out) {
+        out.Write("{\n  \"units\": [");
+        for (size_t i = 0; i < info.units.size(); ++i) {
+            const CompileUnit& unit = info.units[i];
+            NextElement(i, out);
+            ObjectWriter object(out);
+            object.String("name", info.strings.Get(unit.name));
+            object.Unsigned("bank", unit.bank);
+            object.Unsigned("firstType", unit.firstType);
+            object.Unsigned("numTypes", unit.numTypes);
+        }
+        CloseArray(info.units.size(), out);
+
+        out.Write(",\n  \"types\": [");
+        for (size_t i = 0; i < info.types.size(); ++i) {
+            NextElement(i, out);
+            WriteType(info, info.types[i], out);
+        }
+        CloseArray(info.types.size(), out);
+
+        out.Write(",\n  \"symbols\": [");
+        for (size_t i = 0; i < info.symbols.size(); ++i) {
+            NextElement(i, out);
+            WriteSymbol(info, info.symbols[i], out);
+        }
+        CloseArray(info.symbols.size(), out);
+
+        // The line table repeats a handful of files; number them in the order first seen
+        std::unordered_map<StrId, uint32_t> fileIndices;
+        std::vector<StrId> files;
+        for (auto& entry : info.lines) {
+            if (fileIndices.try_emplace(entry.file, static_cast<uint32_t>(files.size())).second)
+                files.push_back(entry.file);
+        }
+        out.Write(",\n  \"files\": [");
+        for (size_t i = 0; i < files.size(); ++i) {
+            NextElement(i, out);
+            out.WriteJsonString(info.strings.Get(files[i]));
+        }
+        CloseArray(files.size(), out);
+
+        // Consecutive entries are mostly in the same file; skip the lookup for those
+        out.Write(",\n  \"lines\": [");
+        StrId lastFile = InvalidStrId;
+        uint32_t fileIndex = 0;
+        for (size_t i = 0; i < info.lines.size(); ++i) {
+            const LineEntry& entry = info.lines[i];
+            if (entry.file != lastFile) {
+                lastFile = entry.file;
+                fileIndex = fileIndices[entry.file];
+            }
+            NextElement(i, out);
+            out.Put('[');
+            out.WriteUnsigned(entry.bank);
+            out.Put(',');
+            out.WriteUnsigned(entry.address);
+            out.Put(',');
+            out.WriteUnsigned(fileIndex);
+            out.Put(',');
+            out.WriteUnsigned(entry.line);
+            out.Put(']');
+        }
+        CloseArray(info.lines.size(), out);
+
+        out.Write(",\n  \"scopes\": [");
+        for (size_t i = 0; i < info.scopes.size(); ++i) {
+            NextElement(i, out);
+            WriteScope(info, info.scopes[i], out);
+        }
+        CloseArray(info.scopes.size(), out);
+        out.Write("\n}\n");
+    }
+
+} // namespace stabs
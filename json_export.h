@@ -0,0 +1,22 @@
+#pragma once
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    class BufferedWriter;
+
+    // Writes the debug tables as one JSON object for external tools, streamed straight from
+    // the flat tables without building a document. Records refer to each other by their index
+    // in the arrays, as in DebugInfo; unknown references and addresses are null.
+    //   units:   {name, bank, firstType, numTypes}
+    //   types:   {kind, name, size, target, count, unit, stabsId} plus members, enumerators,
+    //            bases and methods for the kinds that have them
+    //   symbols: {name, label, file, kind, section, type, address, bank, unit}
+    //   files:   names of the source files of the line table
+    //   lines:   [bank, address, file, line] per entry, file indexing "files"; kept as arrays
+    //            as there can be millions
+    //   scopes:  {parent, function, unit, start, end, variables}
+    void WriteDebugInfoJson(const DebugInfo& info, BufferedWriter& out);
+
+} // namespace stabs
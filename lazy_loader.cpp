@@ -0,0 +1,236 @@
+#include "lazy_loader.h"
+
+#include <algorithm>
+
+#include "char_class.h"
+#include "listing_scan.h"
+#include "mapped_file.h"
+#include "stack_depth.h"
+
+namespace stabs {
+    namespace {
+        // "   086C                     354 _main:" -> "_main"
+        std::string_view LabelName(std::string_view rest) {
+            rest = SkipBlanks(rest);
+            rest.remove_prefix(DigitSet::Span(rest.data(), rest.data() + rest.size()));
+            rest = SkipBlanks(rest);
+            if (rest.empty() || !IdentifierFirstSet::Contains(rest[0]))
+                return {};
+            const size_t length =
+                1 + IdentifierOtherSet::Span(rest.data() + 1, rest.data() + rest.size());
+            if (length >= rest.size() || rest[length] != ':')
+                return {};
+            return rest.substr(0, length);
+        }
+
+        constexpr std::string_view FunctionStabsType = "36"; // N_FUN
+
+        // ".stabs "main:F7",36,0,0,_main" -> "_main". isStatic is set for static functions
+        // ("helper:f7").
+        std::string_view FunctionStabsLabel(std::string_view line, bool& isStatic) {
+            const size_t stabs = line.find(".stabs");
+            if (stabs == std::string_view::npos)
+                return {};
+            const size_t open = line.find('\"', stabs);
+            const size_t close = line.find('\"', open + 1);
+            if (open == std::string_view::npos || close == std::string_view::npos)
+                return {};
+            const std::string_view string = line.substr(open + 1, close - open - 1);
+            const size_t colon = string.find(':');
+            if (colon == std::string_view::npos || colon + 1 == string.size() ||
+                (string[colon + 1] != 'F' && string[colon + 1] != 'f'))
+                return {};
+            std::string_view fields = SkipBlanks(line.substr(close + 1));
+            if (fields.empty() || fields[0] != ',')
+                return {};
+            fields = SkipBlanks(fields.substr(1));
+            if (fields.substr(0, fields.find(',')) != FunctionStabsType)
+                return {};
+            const size_t comma = line.rfind(',');
+            if (comma == std::string_view::npos || comma < close)
+                return {};
+            std::string_view label = SkipBlanks(line.substr(comma + 1));
+            label = label.substr(0, IdentifierOtherSet::Span(label.data(),
+                                                             label.data() + label.size()));
+            isStatic = string[colon + 1] == 'f';
+            return label;
+        }
+    } // namespace
+
+    bool LazyLoader::AddListing(const std::string& path, const LoadOptions& options) {
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+
+        Unit unit;
+        unit.extent.path = path;
+        unit.extent.options = options;
+        unit.extent.firstFunction = static_cast<uint32_t>(m_functions.size());
+        const uint32_t index = static_cast<uint32_t>(m_units.size());
+
+        // Labels are matched to the function stabs once the whole listing is read, as the
+        // stabs of a function follow its code
+        std::unordered_map<std::string_view, uint32_t> labels;
+        std::unordered_map<std::string_view, bool> functionLabels; // To whether static
+        // Runs of contiguous instructions
+        std::vector<Range> ranges;
+        uint32_t runEnd = InvalidAddress;
+
+        std::string_view text = file.Data();
+        while (!text.empty()) {
+            const size_t eol = text.find('\n');
+            std::string_view line = text.substr(0, eol);
+            text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+
+            std::string_view rest = line;
+            uint32_t address = 0;
+            if (options.format == InputFormat::Listing && ParseLineAddress(rest, address)) {
+                if (IsInstruction(rest)) {
+                    if (address != runEnd)
+                        ranges.push_back({options.bank, address, address, index});
+                    runEnd = address + InstructionSize(rest);
+                    ranges.back().lastAddress = std::max(address, runEnd - 1);
+
+                    UnitExtent& extent = unit.extent;
+                    if (extent.firstAddress == InvalidAddress) {
+                        extent.firstAddress = extent.lastAddress = address;
+                    } else {
+                        extent.firstAddress = std::min(extent.firstAddress, address);
+                        extent.lastAddress = std::max(extent.lastAddress, address);
+                    }
+                } else if (auto name = LabelName(rest); !name.empty()) {
+                    labels.try_emplace(name, address);
+                }
+            } else {
+                bool isStatic = false;
+                if (auto label = FunctionStabsLabel(line, isStatic); !label.empty())
+                    functionLabels.try_emplace(label, isStatic);
+            }
+        }
+
+        for (auto [label, isStatic] : functionLabels) {
+            auto it = labels.find(label);
+            const uint32_t address = it != labels.end() ? it->second : InvalidAddress;
+            const StrId id = m_names.Intern(label);
+            m_functions.push_back({id, address, isStatic});
+            if (isStatic)
+                m_staticFunctions.insert(StaticFunctionKey(index, id));
+            else
+                m_functionUnits.try_emplace(id, index);
+        }
+        unit.extent.numFunctions =
+            static_cast<uint32_t>(m_functions.size()) - unit.extent.firstFunction;
+        std::sort(m_functions.begin() + unit.extent.firstFunction, m_functions.end(),
+                  [](const FunctionLabel& a, const FunctionLabel& b) {
+                      return a.address < b.address;
+                  });
+
+        auto less = [](const Range& a, const Range& b) {
+            return a.bank != b.bank ? a.bank < b.bank : a.firstAddress < b.firstAddress;
+        };
+        std::sort(ranges.begin(), ranges.end(), less);
+        const auto middle = m_ranges.insert(m_ranges.end(), ranges.begin(), ranges.end());
+        std::inplace_merge(m_ranges.begin(), middle, m_ranges.end(), less);
+        m_units.push_back(std::move(unit));
+        return true;
+    }
+
+    uint32_t LazyLoader::FindUnit(BankId bank, uint32_t address) const {
+        // Last range starting at or before address
+        auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), std::make_pair(bank, address),
+                                   [](const std::pair<BankId, uint32_t>& key, const Range& range) {
+                                       return key.first != range.bank
+                                                  ? key.first < range.bank
+                                                  : key.second < range.firstAddress;
+                                   });
+        if (it == m_ranges.begin())
+            return InvalidIndex;
+        --it;
+        return it->bank == bank && address <= it->lastAddress ? it->unit : InvalidIndex;
+    }
+
+    uint32_t LazyLoader::FindFunctionUnit(std::string_view label, uint32_t unit) const {
+        const StrId id = m_names.Find(label);
+        if (id == InvalidStrId)
+            return InvalidIndex;
+        if (unit != InvalidIndex && m_staticFunctions.count(StaticFunctionKey(unit, id)) != 0)
+            return unit;
+        auto it = m_functionUnits.find(id);
+        return it != m_functionUnits.end() ? it->second : InvalidIndex;
+    }
+
+    DebugInfo* LazyLoader::TouchUnit(uint32_t unit) {
+        if (unit >= m_units.size())
+            return nullptr;
+        std::unique_lock lock(m_mutex);
+        if (m_units[unit].state == State::Scanned)
+            Load(unit, lock);
+        m_loaded.wait(lock, [&] { return m_units[unit].state == State::Loaded; });
+        return m_units[unit].info.get();
+    }
+
+    DebugInfo* LazyLoader::Loaded(uint32_t unit) const {
+        if (unit >= m_units.size())
+            return nullptr;
+        std::lock_guard lock(m_mutex);
+        return m_units[unit].state == State::Loaded ? m_units[unit].info.get() : nullptr;
+    }
+
+    void LazyLoader::Prioritize(BankId bank, uint32_t address) {
+        const uint32_t unit = FindUnit(bank, address);
+        if (unit == InvalidIndex)
+            return;
+        std::lock_guard lock(m_mutex);
+        m_units[unit].priority = ++m_nextPriority;
+    }
+
+    // Parses the unit with the lock released; the unit's state keeps other threads off it
+    void LazyLoader::Load(uint32_t unit, std::unique_lock<std::mutex>& lock) {
+        m_units[unit].state = State::Loading;
+        const UnitExtent& extent = m_units[unit].extent;
+        lock.unlock();
+
+        auto info = std::make_unique<DebugInfo>();
+        if (!LoadListingFile(extent.path, *info, extent.options))
+            info->Clear(); // Removed since the pre-scan; the unit stays empty
+        ComputeStackDepths(*info);
+
+        lock.lock();
+        m_units[unit].info = std::move(info);
+        m_units[unit].state = State::Loaded;
+        m_loaded.notify_all();
+    }
+
+    void LazyLoader::Run() {
+        std::unique_lock lock(m_mutex);
+        while (!m_stop) {
+            // Highest priority first, then the order the units were added
+            uint32_t next = InvalidIndex;
+            for (uint32_t i = 0; i < m_units.size(); ++i) {
+                if (m_units[i].state == State::Scanned &&
+                    (next == InvalidIndex || m_units[i].priority > m_units[next].priority))
+                    next = i;
+            }
+            if (next == InvalidIndex)
+                break;
+            Load(next, lock);
+        }
+    }
+
+    void LazyLoader::Start() {
+        if (m_thread.joinable())
+            return;
+        m_stop = false;
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    void LazyLoader::Stop() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+} // namespace stabs
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "debug_info.h"
+#include "listing_loader.h"
+
+namespace stabs {
+
+    // What a pre-scan of a listing finds without running the grammar: the span of its
+    // instruction addresses, and the labels of its functions (the values of its "F" and "f" stabs).
+    struct UnitExtent {
+        std::string path;
+        LoadOptions options;
+        // Lowest and highest instr_address, inclusive. Other units' code may lie between.
+        uint32_t firstAddress = InvalidAddress;
+        uint32_t lastAddress = InvalidAddress;
+        uint32_t firstFunction = 0; // Into LazyLoader::FunctionLabels()
+        uint32_t numFunctions = 0;
+    };
+
+    struct FunctionLabel {
+        StrId name = 0; // In LazyLoader::Names()
+        uint32_t address = 0;
+        bool isStatic = false; // An "f" stabs; other units may use the same label
+    };
+
+    // Loads listings when their code is first needed. AddListing only pre-scans a listing; the
+    // unit is fully parsed, into a DebugInfo of its own, the first time the PC, a breakpoint or
+    // a query touches its address range or one of its functions. Start() loads the rest on a
+    // background thread, most recently prioritized units first, then in the order added.
+    //
+    // Add every listing before Start(). Touch functions may be called from any thread; they
+    // block until the unit is loaded, also when the background thread is loading it. A loaded
+    // unit's DebugInfo is not touched by the loader again, and stays valid until destruction.
+    //
+    // Compiler output (InputFormat::Assembly) has no addresses to pre-scan; such units are only
+    // loaded by the background thread or by TouchUnit.
+    //
+    // Stack depths (ComputeStackDepths) are computed per unit as it is loaded; calls into other
+    // units stay unresolved, and their callers are marked incomplete.
+    class LazyLoader {
+    public:
+        LazyLoader() = default;
+        LazyLoader(const LazyLoader&) = delete;
+        LazyLoader& operator=(const LazyLoader&) = delete;
+        ~LazyLoader() { Stop(); }
+
+        // Returns false if the file could not be read
+        bool AddListing(const std::string& path, const LoadOptions& options = {});
+
+        size_t NumUnits() const { return m_units.size(); }
+        const UnitExtent& Extent(uint32_t unit) const { return m_units[unit].extent; }
+        const std::vector<FunctionLabel>& FunctionLabels() const { return m_functions; }
+        const StringPool& Names() const { return m_names; }
+
+        // Unit with an instruction at (bank, address), or InvalidIndex
+        uint32_t FindUnit(BankId bank, uint32_t address) const;
+        // Unit defining the function label (e.g. "_main"), or InvalidIndex. Static functions are
+        // only found from their own unit: the label is first looked up among the statics of
+        // unit, if given, then among the global functions.
+        uint32_t FindFunctionUnit(std::string_view label, uint32_t unit = InvalidIndex) const;
+
+        // The unit's debug info, loading it first if needed. nullptr if there is no such unit.
+        DebugInfo* TouchUnit(uint32_t unit);
+        DebugInfo* Touch(BankId bank, uint32_t address) {
+            return TouchUnit(FindUnit(bank, address));
+        }
+        DebugInfo* TouchFunction(std::string_view label, uint32_t unit = InvalidIndex) {
+            return TouchUnit(FindFunctionUnit(label, unit));
+        }
+
+        // The unit's debug info if it's loaded, without loading it
+        DebugInfo* Loaded(uint32_t unit) const;
+
+        // Moves the unit covering (bank, address) ahead of every unit queued for the background
+        // thread, e.g. for the units of breakpoints
+        void Prioritize(BankId bank, uint32_t address);
+
+        void Start();
+        // Waits for the unit being loaded in the background, if any
+        void Stop();
+
+    private:
+        enum class State : uint8_t { Scanned, Loading, Loaded };
+
+        struct Unit {
+            UnitExtent extent;
+            State state = State::Scanned;
+            uint64_t priority = 0;
+            std::unique_ptr<DebugInfo> info;
+        };
+
+        // A run of contiguous instructions of a unit, sorted by (bank, firstAddress). A unit
+        // has several when its code is in several areas (e.g. _INIT between other units' code)
+        // or is interrupted by data.
+        struct Range {
+            BankId bank;
+            uint32_t firstAddress;
+            uint32_t lastAddress; // Inclusive
+            uint32_t unit;
+        };
+
+        static uint64_t StaticFunctionKey(uint32_t unit, StrId label) {
+            return uint64_t{unit} << 32 | label;
+        }
+
+        void Load(uint32_t unit, std::unique_lock<std::mutex>& lock);
+        void Run();
+
+        std::vector<Unit> m_units;
+        std::vector<Range> m_ranges;
+        std::vector<FunctionLabel> m_functions;
+        StringPool m_names;
+        std::unordered_map<StrId, uint32_t> m_functionUnits; // Global functions
+        std::unordered_set<uint64_t> m_staticFunctions; // StaticFunctionKey
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_loaded;
+        std::thread m_thread;
+        uint64_t m_nextPriority = 0;
+        bool m_stop = false;
+    };
+
+} // namespace stabs
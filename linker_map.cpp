@@ -0,0 +1,105 @@
+#include "linker_map.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "char_class.h"
+#include "mapped_file.h"
+
+namespace stabs {
+    namespace {
+        using HexSet = CharSet<'0', '9', 'A', 'F', 'a', 'f'>;
+
+        bool ParseHex(std::string_view token, uint32_t& value) {
+            if (token.empty() || token.size() > 8 ||
+                HexSet::Span(token.data(), token.data() + token.size()) != token.size())
+                return false;
+            std::from_chars(token.data(), token.data() + token.size(), value, 16);
+            return true;
+        }
+
+        bool IsSymbolName(std::string_view token) {
+            return !token.empty() && (IdentifierFirstSet::Contains(token[0]) || token[0] == '.');
+        }
+
+        // Splits a line at blanks
+        void Tokenize(std::string_view line, std::vector<std::string_view>& tokens) {
+            tokens.clear();
+            size_t i = 0;
+            while (i < line.size()) {
+                while (i < line.size() && (line[i] == ' ' || line[i] == '\t'))
+                    ++i;
+                const size_t begin = i;
+                while (i < line.size() && line[i] != ' ' && line[i] != '\t')
+                    ++i;
+                if (i > begin)
+                    tokens.push_back(line.substr(begin, i - begin));
+            }
+        }
+    } // namespace
+
+    void LinkerMap::Parse(std::string_view text) {
+        std::vector<std::string_view> tokens;
+        while (!text.empty()) {
+            const size_t eol = text.find('\n');
+            std::string_view line = text.substr(0, eol);
+            text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            Tokenize(line, tokens);
+
+            // Area: name, address, size, '='
+            uint32_t start = 0, size = 0;
+            if (tokens.size() >= 4 && IsSymbolName(tokens[0]) && ParseHex(tokens[1], start) &&
+                ParseHex(tokens[2], size) && tokens[3] == "=") {
+                m_areas.push_back({start, start + size});
+                continue;
+            }
+
+            // Symbols: value then name, possibly several per line (older aslink)
+            for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+                uint32_t address = 0;
+                if (!ParseHex(tokens[i], address) || !IsSymbolName(tokens[i + 1]))
+                    continue;
+                const std::string_view name = m_names.Get(m_names.Intern(tokens[i + 1]));
+                if (m_addresses.try_emplace(name, address).second)
+                    m_sorted.push_back(address);
+                ++i;
+            }
+        }
+
+        std::sort(m_sorted.begin(), m_sorted.end());
+        m_sorted.erase(std::unique(m_sorted.begin(), m_sorted.end()), m_sorted.end());
+    }
+
+    bool LinkerMap::Load(const std::string& path) {
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+        Parse(file.Data());
+        return true;
+    }
+
+    uint32_t LinkerMap::Find(std::string_view symbol) const {
+        auto it = m_addresses.find(symbol);
+        return it != m_addresses.end() ? it->second : InvalidAddress;
+    }
+
+    uint32_t LinkerMap::NextAddress(uint32_t address) const {
+        auto next = std::upper_bound(m_sorted.begin(), m_sorted.end(), address);
+        uint32_t result = next != m_sorted.end() ? *next : InvalidAddress;
+        for (auto& area : m_areas) {
+            if (address >= area.start && address < area.end)
+                result = std::min(result, area.end);
+        }
+        return result;
+    }
+
+    void LinkerMap::Clear() {
+        m_names.Clear();
+        m_addresses.clear();
+        m_sorted.clear();
+        m_areas.clear();
+    }
+
+} // namespace stabs
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    // Global symbol addresses from the map of one link (one bank of a banked cartridge). Reads
+    // aslink maps: the areas, and the symbol lists of hex values followed by names.
+    //   Area                       Addr   Size   Decimal Bytes (Attributes)
+    //   _CODE                      0030   1E2B =   7723. bytes (REL,CON)
+    //
+    //         Value  Global
+    //         -----  --------------------------------
+    //          0030  _main
+    // The map is built once per link and probed with the labels of every unit loaded from
+    // compiler output (see InputFormat::Assembly).
+    class LinkerMap {
+    public:
+        void Parse(std::string_view text);
+        // Returns false if the file could not be read
+        bool Load(const std::string& path);
+
+        // InvalidAddress if the symbol isn't in the map
+        uint32_t Find(std::string_view symbol) const;
+
+        // Address of the first symbol after address in the same area, or the end of the area
+        // if there is none. InvalidAddress if neither is known.
+        uint32_t NextAddress(uint32_t address) const;
+
+        size_t Size() const { return m_addresses.size(); }
+        void Clear();
+
+    private:
+        struct Area {
+            uint32_t start;
+            uint32_t end;
+        };
+
+        StringPool m_names; // Keys of m_addresses
+        std::unordered_map<std::string_view, uint32_t> m_addresses;
+        std::vector<uint32_t> m_sorted; // Distinct symbol addresses
+        std::vector<Area> m_areas;
+    };
+
+} // namespace stabs
@@ -0,0 +1,1391 @@
+#include "listing_loader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "debug_info.h"
+#include "linker_map.h"
+#include "lsym_cache.h"
+#include "lsym_parser.h"
+#include "mapped_file.h"
+#include "stabs_grammar.h"
+
+namespace stabs {
+    namespace {
+        // Stabs numbers with a leading 0 are octal (used for 64-bit range bounds)
+        bool ParseStabsInt(std::string_view sv, int64_t& value) {
+            const bool negative = !sv.empty() && sv[0] == '-';
+            if (negative)
+                sv.remove_prefix(1);
+            const int base = (sv.size() > 1 && sv[0] == '0') ? 8 : 10;
+            uint64_t magnitude = 0;
+            auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), magnitude, base);
+            if (ec != std::errc{} || ptr != sv.data() + sv.size())
+                return false;
+            value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+            return true;
+        }
+
+        int64_t ToInt(const Node& node) {
+            int64_t value = 0;
+            ParseStabsInt(node.string_view(), value);
+            return value;
+        }
+
+        uint32_t ParseAddress(std::string_view sv) {
+            uint32_t address = 0;
+            std::from_chars(sv.data(), sv.data() + sv.size(), address, 16);
+            return address;
+        }
+
+        std::string_view TrimRight(std::string_view sv) {
+            while (!sv.empty() && (sv.back() == ' ' || sv.back() == '\t'))
+                sv.remove_suffix(1);
+            return sv;
+        }
+
+        std::string_view Trim(std::string_view sv) {
+            while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t'))
+                sv.remove_prefix(1);
+            return TrimRight(sv);
+        }
+
+        // Splits a .stabs directive into its string and the fields after the string
+        //   95 ;	.stabs	"a:7",128,0,0,0
+        bool SplitStabsLine(std::string_view line, std::string_view& str, std::string_view& rest) {
+            const size_t directive = line.find(".stabs");
+            if (directive == std::string_view::npos)
+                return false;
+            const size_t open = line.find('"', directive);
+            if (open == std::string_view::npos)
+                return false;
+            const size_t close = line.find('"', open + 1);
+            if (close == std::string_view::npos ||
+                !Trim(line.substr(directive + 6, open - directive - 6)).empty())
+                return false;
+
+            str = line.substr(open + 1, close - open - 1);
+            rest = line.substr(close + 1);
+            return true;
+        }
+
+        // Splits an N_LSYM directive without running the grammar
+        bool SplitLsymLine(std::string_view line, std::string_view& lsym, std::string_view& value) {
+            std::string_view rest;
+            if (!SplitStabsLine(line, lsym, rest))
+                return false;
+
+            // Fields after the string: "", type, other, desc, value
+            std::string_view fields[5];
+            for (size_t i = 0; i < 4; ++i) {
+                const size_t comma = rest.find(',');
+                if (comma == std::string_view::npos)
+                    return false;
+                fields[i] = Trim(rest.substr(0, comma));
+                rest.remove_prefix(comma + 1);
+            }
+            fields[4] = Trim(rest);
+            if (!fields[0].empty() || fields[1] != "128")
+                return false;
+
+            value = fields[4];
+            return true;
+        }
+
+        // Size in bytes of a range type "r<id>;<lower>;<upper>;"
+        uint32_t RangeByteSize(std::string_view lowerText, std::string_view upperText) {
+            int64_t lower = 0, upper = 0;
+            if (ParseStabsInt(lowerText, lower) && ParseStabsInt(upperText, upper)) {
+                // If lower > upper, lower is the size in bytes (floating point types)
+                if (upper == 0 && lower > 0)
+                    return static_cast<uint32_t>(lower);
+                const uint64_t span = static_cast<uint64_t>(upper) - static_cast<uint64_t>(lower);
+                uint32_t bytes = 1;
+                while (bytes < 8 && (span >> (bytes * 8)) != 0)
+                    ++bytes;
+                return bytes;
+            }
+            // Too large for 64 bits signed: an octal bound for a 64-bit type
+            return 8;
+        }
+
+        // Effect of an instruction on S that a prologue may start with
+        enum class StackOp : uint8_t {
+            None,
+            Push,     // pshs: value is the postbyte
+            Allocate, // leas -N,s: value is N
+        };
+
+        std::string_view SkipSpace(std::string_view sv) {
+            while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t'))
+                sv.remove_prefix(1);
+            return sv;
+        }
+
+        // "y,u" -> 0x60. Returns 0 for anything else than a register list.
+        uint8_t PushPostbyte(std::string_view registers) {
+            static constexpr struct {
+                std::string_view name;
+                uint8_t bits;
+            } names[] = {{"cc", 0x01}, {"a", 0x02}, {"b", 0x04}, {"d", 0x06}, {"dp", 0x08},
+                         {"x", 0x10},  {"y", 0x20}, {"u", 0x40}, {"pc", 0x80}};
+
+            uint8_t postbyte = 0;
+            while (!registers.empty()) {
+                const size_t comma = registers.find(',');
+                char name[2] = {};
+                const std::string_view reg = Trim(registers.substr(0, comma));
+                if (reg.empty() || reg.size() > 2)
+                    return 0;
+                for (size_t i = 0; i < reg.size(); ++i)
+                    name[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(reg[i])));
+                auto it = std::find_if(std::begin(names), std::end(names), [&](auto& entry) {
+                    return entry.name == std::string_view(name, reg.size());
+                });
+                if (it == std::end(names))
+                    return 0;
+                postbyte |= it->bits;
+                registers.remove_prefix(comma == std::string_view::npos ? registers.size()
+                                                                        : comma + 1);
+            }
+            return postbyte;
+        }
+
+        // Bytes pshs pushes for a postbyte
+        uint8_t PushSize(uint8_t postbyte) {
+            uint8_t size = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (postbyte >> bit & 1)
+                    size += bit >= 4 ? 2 : 1; // X, Y, U and PC are 16-bit
+            }
+            return size;
+        }
+
+        // Mnemonic and operands of an instruction, from the text after the cycle count
+        //   "  126 \tpshs\ty,u\t; tmp33" -> "pshs", "y,u"
+        void SplitInstruction(std::string_view text, std::string_view& mnemonic,
+                              std::string_view& operands) {
+            text = SkipSpace(text);
+            while (!text.empty() && std::isdigit(static_cast<unsigned char>(text.front())))
+                text.remove_prefix(1);
+            text = SkipSpace(text);
+            const size_t mnemonicEnd = std::min(text.find_first_of(" \t;"), text.size());
+            mnemonic = text.substr(0, mnemonicEnd);
+            operands = SkipSpace(text.substr(mnemonicEnd));
+            operands = operands.substr(0, operands.find_first_of(" \t;"));
+        }
+
+        bool IsMnemonic(std::string_view mnemonic, std::string_view lower) {
+            if (mnemonic.size() != lower.size())
+                return false;
+            for (size_t i = 0; i < lower.size(); ++i) {
+                if (std::tolower(static_cast<unsigned char>(mnemonic[i])) != lower[i])
+                    return false;
+            }
+            return true;
+        }
+
+        StackOp DecodeStackOp(std::string_view mnemonic, std::string_view operands,
+                              uint16_t& value) {
+            if (IsMnemonic(mnemonic, "pshs")) {
+                value = PushPostbyte(operands);
+                return value != 0 ? StackOp::Push : StackOp::None;
+            }
+            if (IsMnemonic(mnemonic, "leas")) {
+                // "-4,s": only decimal offsets below S allocate
+                const size_t comma = operands.find(',');
+                if (comma == std::string_view::npos || operands.size() != comma + 2 ||
+                    std::tolower(static_cast<unsigned char>(operands[comma + 1])) != 's')
+                    return StackOp::None;
+                int64_t offset = 0;
+                if (!ParseStabsInt(operands.substr(0, comma), offset) || offset >= 0 ||
+                    offset < -0xFFFF)
+                    return StackOp::None;
+                value = static_cast<uint16_t>(-offset);
+                return StackOp::Allocate;
+            }
+            return StackOp::None;
+        }
+
+        // jsr, bsr or lbsr. target is the label called, or empty if the call is indirect
+        // ("jsr ,x", "jsr [_table]") or to an address.
+        bool DecodeCall(std::string_view mnemonic, std::string_view operands,
+                        std::string_view& target) {
+            if (!IsMnemonic(mnemonic, "jsr") && !IsMnemonic(mnemonic, "bsr") &&
+                !IsMnemonic(mnemonic, "lbsr"))
+                return false;
+            size_t length = 0;
+            if (!operands.empty() && IdentifierFirstSet::Contains(operands[0]))
+                length = 1 + IdentifierOtherSet::Span(operands.data() + 1,
+                                                      operands.data() + operands.size());
+            // "_table,x" is indexed
+            target = length == operands.size() ? operands : std::string_view();
+            return true;
+        }
+
+        constexpr int32_t UnknownDepth = -1; // Of the stack at an instruction
+
+        // How an instruction moves S, to follow the stack through a function's body
+        struct StackEffect {
+            int32_t bytes = 0;    // Pushed; negative if released
+            bool unknown = false; // S is loaded from elsewhere ("tfr x,s", "lds #$CBEA")
+            // rts, rti, puls of PC, jmp, bra and lbra: the next instruction is reached from
+            // elsewhere
+            bool endsFlow = false;
+        };
+
+        // What the loader keeps of an instruction line
+        struct Instruction {
+            uint32_t address;
+            uint32_t size;
+            StackOp stackOp;
+            uint16_t stackValue;
+            StackEffect effect;
+            int32_t depth; // See UnitLoader::FollowStack
+        };
+
+        bool IsSRegister(std::string_view reg) {
+            return reg.size() == 1 && std::tolower(static_cast<unsigned char>(reg[0])) == 's';
+        }
+
+        //   "pshs x" -> 2, "leas 4,s" -> -4, "std ,--s" -> 2, "ldx ,s++" -> -2
+        StackEffect DecodeStackEffect(std::string_view mnemonic, std::string_view operands) {
+            StackEffect effect;
+            const bool pull = IsMnemonic(mnemonic, "puls");
+            if (pull || IsMnemonic(mnemonic, "pshs")) {
+                const uint8_t postbyte = PushPostbyte(operands);
+                effect.bytes = pull ? -PushSize(postbyte) : PushSize(postbyte);
+                effect.endsFlow = pull && (postbyte & 0x80) != 0;
+                return effect;
+            }
+            if (IsMnemonic(mnemonic, "rts") || IsMnemonic(mnemonic, "rti") ||
+                IsMnemonic(mnemonic, "jmp") || IsMnemonic(mnemonic, "bra") ||
+                IsMnemonic(mnemonic, "lbra")) {
+                effect.endsFlow = true;
+                return effect;
+            }
+            if (IsMnemonic(mnemonic, "lds")) {
+                effect.unknown = true;
+                return effect;
+            }
+            const size_t comma = operands.find(',');
+            if (comma == std::string_view::npos)
+                return effect;
+            if (IsMnemonic(mnemonic, "tfr") || IsMnemonic(mnemonic, "exg")) {
+                // tfr writes its second register, exg both
+                effect.unknown = IsSRegister(Trim(operands.substr(comma + 1))) ||
+                                 (IsMnemonic(mnemonic, "exg") &&
+                                  IsSRegister(Trim(operands.substr(0, comma))));
+                return effect;
+            }
+
+            // Indexed on S: auto increment and decrement move it by 1 or 2 whatever the size
+            // of the operand, also when indirect ("[,s++]")
+            std::string_view index = operands.substr(comma + 1);
+            if (!index.empty() && index.back() == ']')
+                index.remove_suffix(1);
+            if (IsMnemonic(index, "--s") || IsMnemonic(index, "-s")) {
+                effect.bytes = static_cast<int32_t>(index.size()) - 1;
+            } else if (IsMnemonic(index, "s++") || IsMnemonic(index, "s+")) {
+                effect.bytes = 1 - static_cast<int32_t>(index.size());
+            } else if (IsMnemonic(mnemonic, "leas")) {
+                // "4,s" releases, "-4,s" allocates; offsets in registers ("d,s") are unknown
+                int64_t offset = 0;
+                if (comma == 0 && IsSRegister(index))
+                    effect.bytes = 0;
+                else if (IsSRegister(index) && ParseStabsInt(operands.substr(0, comma), offset))
+                    effect.bytes = static_cast<int32_t>(-offset);
+                else
+                    effect.unknown = true;
+            }
+            return effect;
+        }
+
+        // jmp, jsr, and the short and long branches ("bne", "lbra"), but not "bita"/"bitb"
+        bool IsJumpOrBranch(std::string_view mnemonic) {
+            if (mnemonic.empty())
+                return false;
+            const int first = std::tolower(static_cast<unsigned char>(mnemonic[0]));
+            return first == 'j' || IsMnemonic(mnemonic.substr(0, 2), "lb") ||
+                   (first == 'b' && !IsMnemonic(mnemonic.substr(0, 3), "bit"));
+        }
+
+        // Label of a memory operand with extended addressing: "_score", "_pos+1" or ">_score".
+        // Empty for other modes and for the targets of jumps and branches.
+        std::string_view ExtendedOperandLabel(std::string_view mnemonic,
+                                              std::string_view operands) {
+            if (mnemonic.empty() || IsJumpOrBranch(mnemonic) ||
+                operands.find(',') != std::string_view::npos)
+                return {};
+            if (operands.size() > 1 && operands[0] == '>')
+                operands.remove_prefix(1);
+            if (operands.empty() || !IdentifierFirstSet::Contains(operands[0]))
+                return {};
+            const char* end = operands.data() + operands.size();
+            const size_t length = 1 + IdentifierOtherSet::Span(operands.data() + 1, end);
+            if (length < operands.size() && operands[length] != '+' && operands[length] != '-')
+                return {};
+            return operands.substr(0, length);
+        }
+
+        class UnitLoader {
+        public:
+            UnitLoader(DebugInfo& info, const std::string& name, const LoadOptions& options)
+                : m_info(info)
+                , m_unit(static_cast<uint32_t>(info.units.size()))
+                , m_bank(options.bank)
+                , m_firstSymbol(info.symbols.size())
+                , m_firstMember(info.members.size())
+                , m_firstBase(info.baseClasses.size())
+                , m_firstMethod(info.methods.size())
+                , m_firstVariable(info.variables.size())
+                , m_cache(options.lsymCache ? *options.lsymCache : LsymCache::Shared())
+                , m_lsymParser(options.lsymParser)
+                , m_linkerMap(options.format == InputFormat::Assembly ? options.linkerMap
+                                                                      : nullptr) {
+                CompileUnit unit;
+                unit.name = m_info.strings.Intern(name);
+                unit.bank = m_bank;
+                unit.firstType = static_cast<TypeId>(m_info.types.size());
+                m_info.units.push_back(unit);
+            }
+
+            void OnLine(const Node& root) {
+                for (auto& node : root.children) {
+                    if (node->is_type<stabs_directive>() ||
+                        node->is_type<stabs_directive_line_table>() ||
+                        node->is_type<stabs_directive_symbols>()) {
+                        OnStabsDirective(*node);
+                    } else if (node->is_type<stabn_directive>()) {
+                        OnStabnDirective(*node);
+                    } else if (node->is_type<stabd_directive>()) {
+                        OnStabdDirective(*node);
+                    } else if (node->is_type<instruction>()) {
+                        OnInstruction(*node);
+                    } else if (node->is_type<label>()) {
+                        OnLabel(*node);
+                    } else if (node->is_type<asm_label>()) {
+                        OnAsmLabel(*node);
+                    }
+                }
+            }
+
+            // GCC splits long strings over several .stabs, each but the last ending in "\\":
+            //   .stabs	"Foo:T26=s4a:7,0,8;\\",128,0,0,0
+            //   .stabs	"b:7,8,8;;",128,0,0,0
+            // Pieces are kept as views of the listing text until the last one has been read, then
+            // joined into a buffer that is reused for every continued string. The joined directive
+            // has the fields of the first piece. Returns false while the string is incomplete.
+            bool JoinContinuation(std::string_view line, std::string_view& joined) {
+                joined = line;
+                std::string_view str, rest;
+                const bool isStabs = SplitStabsLine(line, str, rest);
+                const bool continues = isStabs && str.size() >= 2 &&
+                                       str.substr(str.size() - 2) == "\\\\";
+                // Other lines between the pieces are parsed as usual
+                if (!isStabs || (m_pieces.empty() && !continues))
+                    return true;
+
+                if (m_pieces.empty())
+                    m_continuedFields = rest;
+                m_pieces.push_back(continues ? str.substr(0, str.size() - 2) : str);
+                if (continues)
+                    return false;
+
+                m_joined.assign(".stabs\t\"");
+                for (auto piece : m_pieces)
+                    m_joined.append(piece.data(), piece.size());
+                m_joined += '"';
+                m_joined.append(m_continuedFields.data(), m_continuedFields.size());
+                m_pieces.clear();
+                joined = m_joined;
+                return true;
+            }
+
+            // N_LSYM strings are looked up in the cache before the line is parsed, then given to
+            // the token parser if enabled. Returns true if the string was handled; otherwise the
+            // line is parsed and OnLsym caches its record.
+            bool OnLsymLine(std::string_view line) {
+                m_lsymKeyValid = false;
+                std::string_view lsym, value;
+                if (!SplitLsymLine(line, lsym, value))
+                    return false;
+                NormalizeLsym(lsym, m_lsymKey, m_numbers);
+                m_lsymKeyValid = m_numbers.size() < NoSlot;
+                if (!m_lsymKeyValid)
+                    return false;
+
+                int64_t frameOffset = 0;
+                ParseStabsInt(value, frameOffset);
+                // A hit whose numbers the grammar would reject goes on to be rejected by the
+                // decoders; the cached record is kept for the strings that fit it
+                const auto record = m_cache.Find(m_lsymKey);
+                if (record && CheckLsymNumbers(*record, m_numbers)) {
+                    OnLsymRecord(*record, static_cast<int32_t>(frameOffset));
+                    return true;
+                }
+                return m_lsymParser == LsymParser::Tokens &&
+                       OnLsymTokens(lsym, static_cast<int32_t>(frameOffset));
+            }
+
+            void Finish() {
+                ResolveCrossRefs();
+                LinkTypes();
+                ComputeSizes();
+
+                CompileUnit& unit = m_info.units[m_unit];
+                unit.numTypes = static_cast<uint32_t>(m_info.types.size()) - unit.firstType;
+
+                ResolveSymbols();
+                ResolveScopes();
+                BuildFunctions();
+            }
+
+        private:
+            void OnStabsDirective(const Node& directive) {
+                if (directive.children.empty())
+                    return;
+                const Node& node = *directive.children.front();
+                const Node& value = *directive.children.back();
+
+                if (value.is_type<lsym_value>()) {
+                    int64_t frameOffset = 0;
+                    ParseStabsInt(TrimRight(value.string_view()), frameOffset);
+                    OnLsym(node, static_cast<int32_t>(frameOffset));
+                } else if (node.is_type<stabs_directive_section_symbol>())
+                    OnSectionSymbol(node);
+                else if (node.is_type<include_file>())
+                    m_currentFile = m_info.strings.Intern(node.string_view());
+            }
+
+            // Locals are declared before the N_LBRAC of the block they belong to
+            //   .stabn	192,0,0,LBB2
+            //   .stabn	224,0,0,LBE2
+            void OnStabnDirective(const Node& node) {
+                const auto& c = node.children;
+                if (c.size() < 2)
+                    return;
+
+                // Relative values ("LBB2-_main") still name the absolute label first
+                std::string_view labelName = TrimRight(c[1]->string_view());
+                labelName = labelName.substr(0, labelName.find('-'));
+                const StrId label = m_info.strings.Intern(labelName);
+
+                if (c[0]->is_type<left_brace>()) {
+                    Scope scope;
+                    scope.parent = m_scopeStack.empty() ? InvalidIndex : m_scopeStack.back();
+                    scope.function = m_currentFunction;
+                    scope.unit = m_unit;
+                    scope.firstVariable = static_cast<uint32_t>(m_info.variables.size());
+                    scope.numVariables = static_cast<uint32_t>(m_pendingVariables.size());
+                    m_info.variables.insert(m_info.variables.end(), m_pendingVariables.begin(),
+                                            m_pendingVariables.end());
+                    m_pendingVariables.clear();
+
+                    const auto index = static_cast<uint32_t>(m_info.scopes.size());
+                    m_info.scopes.push_back(scope);
+                    m_scopeStack.push_back(index);
+                    m_scopeLabels.push_back({index, label, true});
+                } else if (!m_scopeStack.empty()) {
+                    m_scopeLabels.push_back({m_scopeStack.back(), label, false});
+                    m_scopeStack.pop_back();
+                }
+            }
+
+            // The line applies to the next instruction
+            void OnStabdDirective(const Node& node) {
+                for (auto& c : node.children) {
+                    if (c->is_type<source_current_line>())
+                        m_pendingLine = static_cast<uint32_t>(ToInt(*c));
+                }
+            }
+
+            //   072B AE E4         [ 5]  126 	ldx	,s	; tmp33, dest
+            void OnInstruction(const Node& node) {
+                const std::string_view address = node.children.front()->string_view();
+                const std::string_view line = node.string_view();
+
+                // Count the hex code bytes between the address and the cycle count
+                const size_t bytesBegin = address.data() + address.size() - line.data();
+                const size_t bytesEnd = line.find('[', bytesBegin);
+                uint32_t hexDigits = 0;
+                for (size_t i = bytesBegin; i < bytesEnd && i < line.size(); ++i) {
+                    if (std::isxdigit(static_cast<unsigned char>(line[i])))
+                        ++hexDigits;
+                }
+                Instruction instr{ParseAddress(address), hexDigits / 2, StackOp::None, 0, {}, 0};
+                const size_t cycles = line.find(']', bytesEnd);
+                if (cycles != std::string_view::npos) {
+                    std::string_view mnemonic, operands, target;
+                    SplitInstruction(line.substr(cycles + 1), mnemonic, operands);
+                    instr.stackOp = DecodeStackOp(mnemonic, operands, instr.stackValue);
+                    instr.effect = DecodeStackEffect(mnemonic, operands);
+                    if (DecodeCall(mnemonic, operands, target)) {
+                        m_calls.push_back({instr.address, target.empty()
+                                                              ? InvalidStrId
+                                                              : m_info.strings.Intern(target)});
+                    } else if (auto label = ExtendedOperandLabel(mnemonic, operands);
+                               !label.empty()) {
+                        LabelReference reference;
+                        reference.label = m_info.strings.Intern(label);
+                        reference.address = instr.address;
+                        reference.bank = m_bank;
+                        m_info.extendedReferences.push_back(reference);
+                    }
+                }
+                m_instructions.push_back(instr);
+
+                if (m_pendingLine != 0) {
+                    LineEntry entry;
+                    entry.address = m_instructions.back().address;
+                    entry.file = m_currentFile;
+                    entry.line = m_pendingLine;
+                    entry.bank = m_bank;
+                    m_info.lines.push_back(entry);
+                    m_pendingLine = 0;
+                }
+            }
+
+            //   086C                     354 Lscope3:
+            void OnLabel(const Node& node) {
+                Label label;
+                label.address = ParseAddress(node.children[0]->string_view());
+                label.name = m_info.strings.Intern(node.children[1]->string_view());
+                label.unit = m_unit;
+                label.bank = m_bank;
+                m_info.labels.push_back(label);
+                m_labelAddresses[label.name] = label.address;
+            }
+
+            // _main:
+            // Hash join with the linker map: only labels the map has get an address. aslink
+            // maps only list globals, so static functions and statics ("__ZL9var_const") get
+            // none; the order of all labels still bounds the functions (see BuildFunctions).
+            void OnAsmLabel(const Node& node) {
+                const std::string_view name = node.children[0]->string_view();
+                const StrId id = m_info.strings.Intern(name);
+                m_asmLabels.push_back(id);
+                const uint32_t address = m_linkerMap ? m_linkerMap->Find(name) : InvalidAddress;
+                if (address == InvalidAddress)
+                    return;
+                Label label;
+                label.address = address;
+                label.name = id;
+                label.unit = m_unit;
+                label.bank = m_bank;
+                m_info.labels.push_back(label);
+                m_labelAddresses[label.name] = label.address;
+            }
+
+            // "main:F7",36,0,0,_main
+            void OnSectionSymbol(const Node& node) {
+                const auto& c = node.children;
+                Symbol symbol;
+                symbol.name = m_info.strings.Intern(c[0]->string_view());
+                if (c[1]->is_type<symbol_type_function>())
+                    symbol.kind = SymbolKind::Function;
+                else if (c[1]->is_type<symbol_type_file_static>())
+                    symbol.kind = SymbolKind::FileStatic;
+                else if (c[1]->is_type<symbol_type_function_static>())
+                    symbol.kind = SymbolKind::FunctionStatic;
+                else
+                    symbol.kind = SymbolKind::Global;
+                symbol.type = TypeRef(ToInt(*c[2]));
+                if (c[3]->is_type<section_text>())
+                    symbol.section = SymbolSection::Text;
+                else if (c[3]->is_type<section_data>())
+                    symbol.section = SymbolSection::Data;
+                else if (c[3]->is_type<section_bss>())
+                    symbol.section = SymbolSection::Bss;
+                // Globals don't carry their label; use the C assembler name
+                symbol.label = symbol.kind == SymbolKind::Global
+                                   ? m_info.strings.Intern("_" + std::string(c[0]->string_view()))
+                                   : m_info.strings.Intern(TrimRight(c[4]->string_view()));
+                symbol.file = m_currentFile;
+                symbol.unit = m_unit;
+                symbol.bank = m_bank;
+
+                const auto index = static_cast<uint32_t>(m_info.symbols.size());
+                m_info.symbols.push_back(symbol);
+
+                if (symbol.kind == SymbolKind::Function) {
+                    m_currentFunction = index;
+                    m_pendingVariables.clear();
+                    m_scopeStack.clear();
+                } else if (symbol.kind == SymbolKind::FunctionStatic) {
+                    Variable var;
+                    var.name = symbol.name;
+                    var.type = symbol.type;
+                    var.symbol = index;
+                    m_pendingVariables.push_back(var);
+                }
+            }
+
+            // Labels may be defined after the stabs that refer to them, so symbols are resolved
+            // once the whole unit has been read.
+            void ResolveSymbols() {
+                for (size_t i = m_firstSymbol; i < m_info.symbols.size(); ++i) {
+                    Symbol& symbol = m_info.symbols[i];
+                    if (auto it = m_labelAddresses.find(symbol.label); it != m_labelAddresses.end())
+                        symbol.address = it->second;
+                }
+            }
+
+            void ResolveScopes() {
+                for (auto& scopeLabel : m_scopeLabels) {
+                    auto it = m_labelAddresses.find(scopeLabel.label);
+                    if (it == m_labelAddresses.end())
+                        continue;
+                    Scope& scope = m_info.scopes[scopeLabel.scope];
+                    (scopeLabel.isStart ? scope.start : scope.end) = it->second;
+                }
+            }
+
+            // A function spans from its label up to the end of the last instruction before the
+            // next function.
+            void BuildFunctions() {
+                const size_t first = m_info.functions.size();
+                for (size_t i = m_firstSymbol; i < m_info.symbols.size(); ++i) {
+                    const Symbol& symbol = m_info.symbols[i];
+                    if (symbol.kind == SymbolKind::Function && symbol.address != InvalidAddress) {
+                        Function function;
+                        function.symbol = static_cast<uint32_t>(i);
+                        function.start = function.end = symbol.address;
+                        function.bank = m_bank;
+                        m_info.functions.push_back(function);
+                    }
+                }
+
+                const auto begin = m_info.functions.begin() + first;
+                const auto end = m_info.functions.end();
+                std::sort(begin, end, [](auto& a, auto& b) { return a.start < b.start; });
+
+                // Compiler output has no instruction addresses
+                if (m_linkerMap) {
+                    for (auto function = begin; function != end; ++function) {
+                        const uint32_t next = m_linkerMap->NextAddress(function->start);
+                        if (next != InvalidAddress)
+                            function->end = next;
+                    }
+                    CapAtUnplacedCode(begin, end);
+                    return;
+                }
+                std::sort(m_instructions.begin(), m_instructions.end(),
+                          [](auto& a, auto& b) { return a.address < b.address; });
+
+                auto function = begin;
+                for (auto& instr : m_instructions) {
+                    while (function != end && std::next(function) != end &&
+                           instr.address >= std::next(function)->start)
+                        ++function;
+                    if (function == end || instr.address < function->start)
+                        continue;
+                    function->end = std::max(function->end, instr.address + instr.size);
+                }
+
+                for (auto f = begin; f != end; ++f) {
+                    f->frame = AnalyzePrologue(*f);
+                    FollowStack(*f);
+                }
+
+                // Callees are resolved with the whole program (see ComputeStackDepths)
+                for (auto& pending : m_calls) {
+                    auto f = std::upper_bound(
+                        begin, end, pending.address,
+                        [](uint32_t address, const Function& g) { return address < g.start; });
+                    if (f == begin || pending.address >= std::prev(f)->end)
+                        continue;
+                    Call call;
+                    call.caller = static_cast<uint32_t>(std::prev(f) - m_info.functions.begin());
+                    call.address = pending.address;
+                    call.target = pending.target;
+                    call.bank = m_bank;
+                    const Function& caller = *std::prev(f);
+                    const int32_t depth = FindInstruction(pending.address)->depth;
+                    const int32_t frame = caller.frame.savedSize + caller.frame.localsSize;
+                    if (depth != UnknownDepth && depth > frame)
+                        call.pushedBytes = static_cast<uint32_t>(depth - frame);
+                    m_info.calls.push_back(call);
+                }
+            }
+
+            // Code follows the source order of the labels. A static function (or static in the
+            // text section) after a function isn't in the map, so NextAddress would extend the
+            // function over its code; the end of such a function is unknown, and left at its
+            // start.
+            void CapAtUnplacedCode(std::vector<Function>::iterator begin,
+                                   std::vector<Function>::iterator end) {
+                std::unordered_map<StrId, Function*> starts;
+                for (auto function = begin; function != end; ++function)
+                    starts.try_emplace(m_info.symbols[function->symbol].label, &*function);
+                std::unordered_set<StrId> unplaced;
+                for (size_t i = m_firstSymbol; i < m_info.symbols.size(); ++i) {
+                    const Symbol& symbol = m_info.symbols[i];
+                    if (symbol.address == InvalidAddress &&
+                        (symbol.kind == SymbolKind::Function ||
+                         symbol.section == SymbolSection::Text))
+                        unplaced.insert(symbol.label);
+                }
+                if (unplaced.empty())
+                    return;
+
+                Function* open = nullptr;
+                for (StrId label : m_asmLabels) {
+                    if (auto it = starts.find(label); it != starts.end()) {
+                        open = it->second;
+                    } else if (open && unplaced.count(label) != 0) {
+                        open->end = open->start;
+                        open = nullptr;
+                    }
+                }
+            }
+
+            // First instruction at or after address, once BuildFunctions has sorted them
+            std::vector<Instruction>::iterator FindInstruction(uint32_t address) {
+                return std::lower_bound(
+                    m_instructions.begin(), m_instructions.end(), address,
+                    [](const Instruction& i, uint32_t a) { return i.address < a; });
+            }
+
+            // Sets the depth of the function's instructions: the bytes the function has on the
+            // stack below its return address before each runs, following S in address order.
+            // Code after an instruction that ends the flow (a return or a jump) is taken to be
+            // at the depth of the body, after the prologue, as is the code GCC generates. Once S
+            // is loaded from elsewhere, the depth is unknown up to the next such instruction.
+            // The offsets where the depth changes are added to stackDepths.
+            void FollowStack(Function& function) {
+                const int32_t body = function.frame.savedSize + function.frame.localsSize;
+                function.firstStackDepth = static_cast<uint32_t>(m_info.stackDepths.size());
+                int32_t depth = 0, recorded = 0;
+                for (auto instr = FindInstruction(function.start);
+                     instr != m_instructions.end() && instr->address < function.end; ++instr) {
+                    instr->depth = depth;
+                    if (depth != recorded ||
+                        m_info.stackDepths.size() == function.firstStackDepth) {
+                        m_info.stackDepths.push_back(
+                            {instr->address - function.start,
+                             depth == UnknownDepth ? UnknownStackDepth
+                                                   : static_cast<uint32_t>(depth)});
+                        recorded = depth;
+                    }
+                    if (instr->effect.endsFlow)
+                        depth = body;
+                    else if (instr->effect.unknown || depth == UnknownDepth ||
+                             depth + instr->effect.bytes < 0)
+                        depth = UnknownDepth;
+                    else
+                        depth += instr->effect.bytes;
+                }
+                function.numStackDepths =
+                    static_cast<uint32_t>(m_info.stackDepths.size()) - function.firstStackDepth;
+            }
+
+            // The prologue is an optional pshs then an optional leas allocating the locals, at
+            // the start of the function
+            FrameLayout AnalyzePrologue(const Function& function) const {
+                FrameLayout frame;
+                auto instr = std::lower_bound(
+                    m_instructions.begin(), m_instructions.end(), function.start,
+                    [](const Instruction& i, uint32_t address) { return i.address < address; });
+                if (instr != m_instructions.end() && instr->address == function.start &&
+                    instr->stackOp == StackOp::Push) {
+                    frame.savedRegisters = static_cast<uint8_t>(instr->stackValue);
+                    frame.savedSize = PushSize(frame.savedRegisters);
+                    frame.pushEnd = static_cast<uint8_t>(instr->size);
+                    ++instr;
+                }
+                const uint32_t next = function.start + frame.pushEnd;
+                if (instr != m_instructions.end() && instr->address == next &&
+                    instr->stackOp == StackOp::Allocate && next + instr->size <= function.end) {
+                    frame.localsSize = instr->stackValue;
+                    frame.allocateEnd = static_cast<uint8_t>(frame.pushEnd + instr->size);
+                }
+                return frame;
+            }
+
+            // Type numbers index a flat table. GCC numbers the types of each unit from 1 up.
+            static constexpr int64_t MaxTypeNumber = int64_t{1} << 20;
+
+            // The type with the given number in this unit, created by its definition. Types out
+            // of the table's range are still created, but can't be referred to.
+            TypeId DefineType(int64_t number) {
+                const bool indexed = number >= 0 && number < MaxTypeNumber;
+                if (indexed) {
+                    if (static_cast<size_t>(number) >= m_typeIds.size())
+                        m_typeIds.resize(static_cast<size_t>(number) + 1, InvalidTypeId);
+                    if (m_typeIds[number] != InvalidTypeId)
+                        return m_typeIds[number];
+                }
+
+                const auto id = static_cast<TypeId>(m_info.types.size());
+                Type type;
+                type.unit = m_unit;
+                type.stabsId = static_cast<int32_t>(number);
+                m_info.types.push_back(type);
+                if (indexed)
+                    m_typeIds[number] = id;
+                return id;
+            }
+
+            // Members and variables often refer to types defined after them. Until the unit has
+            // been read, references hold the type number (see LinkTypes).
+            static TypeId TypeRef(int64_t number) {
+                return number >= 0 && number < MaxTypeNumber ? static_cast<TypeId>(number)
+                                                             : InvalidTypeId;
+            }
+
+            TypeId TypeRef(NumberSlot slot) const {
+                return slot == NoSlot ? InvalidTypeId : TypeRef(Number(slot));
+            }
+
+            TypeId Link(TypeId number) {
+                // Numbers the unit never defines get an Unknown placeholder
+                return number == InvalidTypeId ? InvalidTypeId : DefineType(number);
+            }
+
+            // Turns the type numbers of everything the unit added into TypeIds, in one pass
+            // over each table
+            void LinkTypes() {
+                const auto endType = static_cast<TypeId>(m_info.types.size());
+                for (TypeId id = m_info.units[m_unit].firstType; id < endType; ++id) {
+                    const TypeId target = Link(m_info.types[id].target);
+                    m_info.types[id].target = target;
+                }
+                for (size_t i = m_firstMember; i < m_info.members.size(); ++i)
+                    m_info.members[i].type = Link(m_info.members[i].type);
+                for (size_t i = m_firstBase; i < m_info.baseClasses.size(); ++i)
+                    m_info.baseClasses[i].type = Link(m_info.baseClasses[i].type);
+                for (size_t i = m_firstMethod; i < m_info.methods.size(); ++i)
+                    m_info.methods[i].type = Link(m_info.methods[i].type);
+                for (size_t i = m_firstSymbol; i < m_info.symbols.size(); ++i)
+                    m_info.symbols[i].type = Link(m_info.symbols[i].type);
+                for (size_t i = m_firstVariable; i < m_info.variables.size(); ++i)
+                    m_info.variables[i].type = Link(m_info.variables[i].type);
+            }
+
+            // "xsFoo:" refers to the struct named Foo, which may be defined anywhere in the unit,
+            // or only declared
+            void ResolveCrossRefs() {
+                const auto key = [](TypeKind kind, StrId name) {
+                    return uint64_t{name} << 8 | static_cast<uint8_t>(kind);
+                };
+                std::unordered_map<uint64_t, TypeId> tags;
+                for (TypeId id = m_info.units[m_unit].firstType; id < m_info.types.size(); ++id) {
+                    const Type& type = m_info.types[id];
+                    if (type.name != 0 && (type.kind == TypeKind::Struct ||
+                                           type.kind == TypeKind::Union ||
+                                           type.kind == TypeKind::Enum))
+                        tags.try_emplace(key(type.kind, type.name), id);
+                }
+
+                for (auto& ref : m_crossRefs) {
+                    Type& type = m_info.types[ref.type];
+                    if (auto it = tags.find(key(ref.kind, type.name)); it != tags.end()) {
+                        type.kind = TypeKind::Typedef;
+                        type.target = it->second;
+                    } else {
+                        type.kind = ref.kind;
+                    }
+                }
+            }
+
+            uint32_t SizeOf(TypeId id, uint32_t intSize, int depth = 0) const {
+                if (id >= m_info.types.size() || depth == 64)
+                    return 0;
+                const Type& type = m_info.types[id];
+                switch (type.kind) {
+                case TypeKind::Array:
+                    return type.count * SizeOf(type.target, intSize, depth + 1);
+                case TypeKind::Const:
+                case TypeKind::Volatile:
+                case TypeKind::Typedef:
+                    return SizeOf(type.target, intSize, depth + 1);
+                case TypeKind::Enum:
+                    // Only declared if it has no values
+                    return type.numChildren != 0 ? intSize : 0;
+                default:
+                    return type.byteSize;
+                }
+            }
+
+            // Sizes that depend on other types, which are only known once the unit is linked
+            void ComputeSizes() {
+                const TypeId first = m_info.units[m_unit].firstType;
+                // Enums are int sized
+                uint32_t intSize = 0;
+                for (TypeId id = first; id < m_info.types.size(); ++id) {
+                    const Type& type = m_info.types[id];
+                    if (type.kind == TypeKind::Base && m_info.strings.Get(type.name) == "int")
+                        intSize = type.byteSize;
+                }
+                for (TypeId id = first; id < m_info.types.size(); ++id)
+                    m_info.types[id].byteSize = SizeOf(id, intSize);
+            }
+
+            // Decodes a parsed lsym string, and caches the record for units that repeat the string
+            void OnLsym(const Node& node, int32_t frameOffset) {
+                // Lines that didn't split have no key; all their numbers are added by SlotOf
+                if (!m_lsymKeyValid)
+                    m_numbers.clear();
+                LsymSlots slots(m_numbers, m_lsymKeyValid);
+
+                auto record = std::make_shared<LsymRecord>();
+                DecodeLsym(node, *record, slots);
+                OnLsymRecord(*record, frameOffset);
+                if (slots.Cacheable())
+                    m_cache.Insert(m_lsymKey, std::move(record));
+            }
+
+            bool OnLsymTokens(std::string_view lsym, int32_t frameOffset) {
+                const size_t numNormalized = m_numbers.size();
+                LsymSlots slots(m_numbers, true);
+                auto record = std::make_shared<LsymRecord>();
+                LexLsym(lsym, m_tokens);
+                if (!ParseLsymTokens(lsym, m_tokens, slots, *record)) {
+                    // Leave the grammar only the normalized numbers
+                    m_numbers.resize(numNormalized);
+                    return false;
+                }
+
+                OnLsymRecord(*record, frameOffset);
+                if (slots.Cacheable())
+                    m_cache.Insert(m_lsymKey, std::move(record));
+                return true;
+            }
+
+            static NumberSlot SlotOf(const Node& node, LsymSlots& slots) {
+                return slots.SlotOf(node.string_view());
+            }
+
+            static std::string NameOf(const Node& node, LsymSlots& slots) {
+                return slots.NameOf(TrimRight(node.string_view()));
+            }
+
+            static void DecodeLsym(const Node& node, LsymRecord& record, LsymSlots& slots) {
+                // Children: the name, 't' of "Tt", then the type_ref
+                const auto& c = node.children;
+                if (node.is_type<type_def>())
+                    record.kind = LsymRecord::Kind::TypeDef;
+                else if (node.is_type<tag_def>())
+                    record.kind = c[1]->is_type<tag_type_def>() ? LsymRecord::Kind::TagTypeDef
+                                                                : LsymRecord::Kind::Tag;
+                else
+                    record.kind = LsymRecord::Kind::Variable;
+                record.name = NameOf(*c[0], slots);
+                record.type = DecodeTypeRef(*c.back(), record, slots);
+            }
+
+            // type_ref: a type number, and its definition if any
+            static NumberSlot DecodeTypeRef(const Node& node, LsymRecord& record,
+                                            LsymSlots& slots) {
+                const auto& c = node.children;
+                const NumberSlot id = SlotOf(*c[0], slots);
+                if (c.size() > 1) {
+                    LsymRecord::TypeDesc desc;
+                    desc.id = id;
+                    DecodeTypeDesc(*c[1], desc, record, slots);
+                    // Nested definitions were added first
+                    record.types.push_back(std::move(desc));
+                }
+                return id;
+            }
+
+            static void DecodeTypeDesc(const Node& node, LsymRecord::TypeDesc& desc,
+                                       LsymRecord& record, LsymSlots& slots) {
+                using Kind = LsymRecord::TypeDesc::Kind;
+                const auto& c = node.children;
+                if (node.is_type<alias_type>() || node.is_type<pointer_type>() ||
+                    node.is_type<const_type>() || node.is_type<volatile_type>() ||
+                    node.is_type<function_type>()) {
+                    desc.kind = node.is_type<alias_type>()      ? Kind::Alias
+                                : node.is_type<pointer_type>()  ? Kind::Pointer
+                                : node.is_type<const_type>()    ? Kind::Const
+                                : node.is_type<volatile_type>() ? Kind::Volatile
+                                                                : Kind::Function;
+                    desc.target = DecodeTypeRef(*c[0], record, slots);
+                } else if (node.is_type<method_type>()) {
+                    // Children: method_return, or the class, method_return and argument types
+                    desc.kind = Kind::Function;
+                    for (auto& child : c) {
+                        if (child->is_type<method_return>())
+                            desc.target = DecodeTypeRef(*child->children[0], record, slots);
+                        else
+                            DecodeTypeRef(*child, record, slots);
+                    }
+                } else if (node.is_type<range_type>()) {
+                    desc.kind = Kind::Range;
+                    DecodeTypeRef(*c[0], record, slots);
+                    desc.lowerBound = SlotOf(*c[1], slots);
+                    desc.upperBound = SlotOf(*c[2], slots);
+                } else if (node.is_type<array_type>()) {
+                    // Children: index type, bounds, element type
+                    desc.kind = Kind::Array;
+                    DecodeTypeRef(*c[0], record, slots);
+                    desc.lowerBound = SlotOf(*c[1], slots);
+                    desc.upperBound = SlotOf(*c[2], slots);
+                    desc.target = DecodeTypeRef(*c[3], record, slots);
+                } else if (node.is_type<enum_type>()) {
+                    // Children: (enum_value_id, enum_value_num)*
+                    desc.kind = Kind::Enum;
+                    desc.first = static_cast<uint32_t>(record.values.size());
+                    for (size_t i = 0; i + 1 < c.size(); i += 2)
+                        record.values.push_back({NameOf(*c[i], slots), SlotOf(*c[i + 1], slots)});
+                    desc.count = static_cast<uint32_t>(record.values.size()) - desc.first;
+                } else if (node.is_type<struct_type>() || node.is_type<union_type>()) {
+                    desc.kind = node.is_type<struct_type>() ? Kind::Struct : Kind::Union;
+                    DecodeAggregate(node, desc, record, slots);
+                } else if (node.is_type<xref_type>()) {
+                    desc.kind = Kind::CrossRef;
+                    desc.tag = c[0]->string_view()[0];
+                    desc.name = slots.NameOf(c[1]->string_view());
+                }
+            }
+
+            // Children: struct_byte_size, base_class*, struct_member*, method*, vtable_holder?
+            static void DecodeAggregate(const Node& node, LsymRecord::TypeDesc& desc,
+                                        LsymRecord& record, LsymSlots& slots) {
+                const auto& c = node.children;
+                desc.byteSize = SlotOf(*c[0], slots);
+
+                // Members may define structs of their own, so this one's are added at the end
+                std::vector<LsymRecord::Base> bases;
+                std::vector<LsymRecord::Member> members;
+                std::vector<LsymRecord::Method> methods;
+                for (size_t i = 1; i < c.size(); ++i) {
+                    const Node& child = *c[i];
+                    const auto& m = child.children;
+                    if (child.is_type<base_class>()) {
+                        bases.push_back(
+                            {SlotOf(*m[0], slots), DecodeTypeRef(*m[1], record, slots)});
+                    } else if (child.is_type<struct_member>()) {
+                        // Children: struct_member_name, type_ref, bit offset, bit size
+                        members.push_back({slots.NameOf(m[0]->string_view()),
+                                           DecodeTypeRef(*m[1], record, slots),
+                                           SlotOf(*m[2], slots), SlotOf(*m[3], slots)});
+                    } else if (child.is_type<method>()) {
+                        // Children: method_name, then method_variant per overload
+                        for (size_t j = 1; j < m.size(); ++j)
+                            methods.push_back(DecodeMethod(m[0]->string_view(), *m[j], record,
+                                                           slots));
+                    } else {
+                        DecodeTypeRef(*m[0], record, slots); // vtable_holder
+                    }
+                }
+
+                desc.firstBase = static_cast<uint32_t>(record.bases.size());
+                desc.numBases = static_cast<uint32_t>(bases.size());
+                desc.first = static_cast<uint32_t>(record.members.size());
+                desc.count = static_cast<uint32_t>(members.size());
+                desc.firstMethod = static_cast<uint32_t>(record.methods.size());
+                desc.numMethods = static_cast<uint32_t>(methods.size());
+                std::move(bases.begin(), bases.end(), std::back_inserter(record.bases));
+                std::move(members.begin(), members.end(), std::back_inserter(record.members));
+                std::move(methods.begin(), methods.end(), std::back_inserter(record.methods));
+            }
+
+            // Children: type_ref, method_phys_name, method_access, then method_virtual or
+            // method_static if either
+            static LsymRecord::Method DecodeMethod(std::string_view name, const Node& variant,
+                                                   LsymRecord& record, LsymSlots& slots) {
+                const auto& v = variant.children;
+                LsymRecord::Method method;
+                method.name = slots.NameOf(name);
+                method.type = DecodeTypeRef(*v[0], record, slots);
+                method.physName = slots.NameOf(v[1]->string_view());
+                method.access = SlotOf(*v[2], slots);
+                if (v.size() > 3 && v[3]->is_type<method_virtual>()) {
+                    method.isVirtual = true;
+                    DecodeTypeRef(*v[3]->children[0], record, slots);
+                } else {
+                    method.isStatic = v.size() > 3;
+                }
+                return method;
+            }
+
+            int64_t Number(NumberSlot slot) const {
+                int64_t value = 0;
+                if (slot < m_numbers.size())
+                    ParseStabsInt(m_numbers[slot], value);
+                return value;
+            }
+
+            // Numbers are taken from the string of the current line, so a record applies to any
+            // string with its shape.
+            void OnLsymRecord(const LsymRecord& record, int32_t frameOffset) {
+                for (auto& desc : record.types)
+                    OnTypeDesc(record, desc);
+
+                switch (record.kind) {
+                case LsymRecord::Kind::TypeDef:
+                    OnTypeDef(record);
+                    break;
+                case LsymRecord::Kind::Tag:
+                case LsymRecord::Kind::TagTypeDef:
+                    OnTag(record);
+                    break;
+                case LsymRecord::Kind::Variable:
+                    OnVariable(record, frameOffset);
+                    break;
+                }
+            }
+
+            // Defines a type number; the types it refers to are linked when the unit is finished
+            void OnTypeDesc(const LsymRecord& record, const LsymRecord::TypeDesc& desc) {
+                using Kind = LsymRecord::TypeDesc::Kind;
+                const TypeId id = DefineType(Number(desc.id));
+                // Only DefineType adds types, so the reference stays valid
+                Type& type = m_info.types[id];
+                type.target = TypeRef(desc.target);
+
+                switch (desc.kind) {
+                case Kind::Alias:
+                    type.kind = TypeKind::Typedef;
+                    break;
+                case Kind::Range:
+                    type.kind = TypeKind::Base;
+                    type.byteSize =
+                        RangeByteSize(m_numbers[desc.lowerBound], m_numbers[desc.upperBound]);
+                    break;
+                case Kind::Pointer:
+                    type.kind = TypeKind::Pointer;
+                    type.byteSize = 2;
+                    break;
+                case Kind::Const:
+                    type.kind = TypeKind::Const;
+                    break;
+                case Kind::Volatile:
+                    type.kind = TypeKind::Volatile;
+                    break;
+                case Kind::Function:
+                    type.kind = TypeKind::Function;
+                    break;
+                case Kind::Array:
+                    type.kind = TypeKind::Array;
+                    // "ar1;0;-1;" is an array of unknown size
+                    type.count = static_cast<uint32_t>(std::max<int64_t>(
+                        Number(desc.upperBound) - Number(desc.lowerBound) + 1, 0));
+                    break;
+                case Kind::Enum:
+                    type.kind = TypeKind::Enum;
+                    type.first = static_cast<uint32_t>(m_info.enumerators.size());
+                    type.numChildren = desc.count;
+                    for (uint32_t i = desc.first; i < desc.first + desc.count; ++i) {
+                        Enumerator e;
+                        e.name = m_info.strings.Intern(record.values[i].name);
+                        e.value = Number(record.values[i].value);
+                        m_info.enumerators.push_back(e);
+                    }
+                    break;
+                case Kind::Struct:
+                case Kind::Union:
+                    type.kind = desc.kind == Kind::Struct ? TypeKind::Struct : TypeKind::Union;
+                    type.byteSize = static_cast<uint32_t>(Number(desc.byteSize));
+                    OnAggregate(record, desc, type);
+                    break;
+                case Kind::CrossRef:
+                    type.name = m_info.strings.Intern(desc.name);
+                    m_crossRefs.push_back({id, desc.tag == 's'   ? TypeKind::Struct
+                                               : desc.tag == 'u' ? TypeKind::Union
+                                                                 : TypeKind::Enum});
+                    break;
+                }
+            }
+
+            // "s4a:7,0,8;b:7,8,8;;", "s6!1,020,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;"
+            void OnAggregate(const LsymRecord& record, const LsymRecord::TypeDesc& desc,
+                             Type& type) {
+                type.first = static_cast<uint32_t>(m_info.members.size());
+                type.numChildren = desc.count;
+                for (uint32_t i = desc.first; i < desc.first + desc.count; ++i) {
+                    const LsymRecord::Member& m = record.members[i];
+                    StructMember member;
+                    member.name = m_info.strings.Intern(m.name);
+                    member.type = TypeRef(m.type);
+                    member.bitOffset = static_cast<uint32_t>(Number(m.bitOffset));
+                    member.bitSize = static_cast<uint32_t>(Number(m.bitSize));
+                    m_info.members.push_back(member);
+                }
+
+                // "020": virtual flag, access, then the decimal bit offset
+                type.firstBase = static_cast<uint32_t>(m_info.baseClasses.size());
+                type.numBases = desc.numBases;
+                for (uint32_t i = desc.firstBase; i < desc.firstBase + desc.numBases; ++i) {
+                    const std::string_view spec = m_numbers[record.bases[i].spec];
+                    BaseClass base;
+                    base.type = TypeRef(record.bases[i].type);
+                    if (spec.size() >= 3) {
+                        base.isVirtual = spec[0] == '1';
+                        base.access = ToAccess(spec[1]);
+                        std::from_chars(spec.data() + 2, spec.data() + spec.size(),
+                                        base.bitOffset);
+                    }
+                    m_info.baseClasses.push_back(base);
+                }
+
+                type.firstMethod = static_cast<uint32_t>(m_info.methods.size());
+                type.numMethods = desc.numMethods;
+                for (uint32_t i = desc.firstMethod; i < desc.firstMethod + desc.numMethods; ++i) {
+                    const LsymRecord::Method& m = record.methods[i];
+                    Method method;
+                    method.name = m_info.strings.Intern(m.name);
+                    method.physName = m_info.strings.Intern(m.physName);
+                    method.type = TypeRef(m.type);
+                    method.access = ToAccess(m_numbers[m.access][0]);
+                    method.isVirtual = m.isVirtual;
+                    method.isStatic = m.isStatic;
+                    m_info.methods.push_back(method);
+                }
+            }
+
+            static Access ToAccess(char digit) {
+                return digit == '0' ? Access::Private
+                                    : digit == '1' ? Access::Protected : Access::Public;
+            }
+
+            // "int:t7=r7;-32768;32767;", "myint:t26=7", "bool:t22=eFalse:0,True:1,;"
+            void OnTypeDef(const LsymRecord& record) {
+                Type& type = m_info.types[DefineType(Number(record.type))];
+                // "int:t7" names a type without describing it
+                if (type.kind == TypeKind::Unknown)
+                    type.kind = TypeKind::Base;
+                if (type.name == 0)
+                    type.name = m_info.strings.Intern(record.name);
+            }
+
+            // "Foo:T26=s4a:7,0,8;b:7,8,8;c:7,16,8;d:7,24,6;e:7,30,2;;"
+            void OnTag(const LsymRecord& record) {
+                Type& type = m_info.types[DefineType(Number(record.type))];
+                type.name = m_info.strings.Intern(record.name);
+            }
+
+            // "a:7", "p:25=*7", "c:25=ar26=r26;0;-1;;0;9;27=ar26;0;10;28=ar26;0;11;7"
+            void OnVariable(const LsymRecord& record, int32_t frameOffset) {
+                Variable var;
+                var.name = m_info.strings.Intern(record.name);
+                var.type = TypeRef(record.type);
+                var.frameOffset = frameOffset;
+                m_pendingVariables.push_back(var);
+            }
+
+            DebugInfo& m_info;
+            const uint32_t m_unit;
+            const BankId m_bank;
+            const size_t m_firstSymbol;
+            const size_t m_firstMember;
+            const size_t m_firstBase;
+            const size_t m_firstMethod;
+            const size_t m_firstVariable;
+            // Types of this unit by stabs number, which is only unique within a compile unit
+            std::vector<TypeId> m_typeIds;
+
+            struct CrossRef {
+                TypeId type;
+                TypeKind kind; // Of the type referred to
+            };
+            std::vector<CrossRef> m_crossRefs;
+            // Local labels (LBB2, Lscope1, ...) are reused by every unit
+            std::unordered_map<StrId, uint32_t> m_labelAddresses;
+            std::vector<Instruction> m_instructions;
+
+            struct PendingCall {
+                uint32_t address;
+                StrId target;
+            };
+            std::vector<PendingCall> m_calls;
+            StrId m_currentFile = 0;
+            uint32_t m_pendingLine = 0;
+
+            struct ScopeLabel {
+                uint32_t scope;
+                StrId label;
+                bool isStart;
+            };
+
+            uint32_t m_currentFunction = InvalidIndex;
+            std::vector<Variable> m_pendingVariables;
+            std::vector<uint32_t> m_scopeStack;
+            std::vector<ScopeLabel> m_scopeLabels;
+
+            // Current N_LSYM string: its normalized key and numbers
+            LsymCache& m_cache;
+            std::string m_lsymKey;
+            std::vector<std::string_view> m_numbers;
+            bool m_lsymKeyValid = false;
+            const LsymParser m_lsymParser;
+            std::vector<LsymToken> m_tokens;
+
+            // Assembly only
+            const LinkerMap* m_linkerMap;
+            std::vector<StrId> m_asmLabels; // Every label, in source order
+
+            // Backslash-continued .stabs: the pieces read so far, and the joined directive
+            std::vector<std::string_view> m_pieces;
+            std::string_view m_continuedFields;
+            std::string m_joined;
+        };
+
+        template <typename LINE>
+        void ParseLines(std::string_view text, const std::string& unitName, UnitLoader& loader) {
+            while (!text.empty()) {
+                const size_t eol = text.find('\n');
+                std::string_view line = text.substr(0, eol);
+                text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+                if (!loader.JoinContinuation(line, line))
+                    continue;
+
+                // Only the full profile and compiler output parse N_LSYM strings
+                if constexpr (std::is_same_v<LINE, listing_line> ||
+                              std::is_same_v<LINE, assembly_line>) {
+                    if (loader.OnLsymLine(line))
+                        continue;
+                }
+
+                pegtl::memory_input<> in(line.data(), line.size(), unitName);
+                if (const auto root = pegtl::parse_tree::parse<LINE, Node, selector>(in))
+                    loader.OnLine(*root);
+            }
+        }
+
+    } // namespace
+
+    void LoadListing(std::string_view text, const std::string& unitName, DebugInfo& info,
+                     const LoadOptions& options) {
+        UnitLoader loader(info, unitName, options);
+
+        if (options.format == InputFormat::Assembly) {
+            ParseLines<assembly_line>(text, unitName, loader);
+            loader.Finish();
+            return;
+        }
+
+        switch (options.profile) {
+        case CaptureProfile::Full:
+            ParseLines<listing_line>(text, unitName, loader);
+            break;
+        case CaptureProfile::LineTable:
+            ParseLines<listing_line_line_table>(text, unitName, loader);
+            break;
+        case CaptureProfile::Symbols:
+            ParseLines<listing_line_symbols>(text, unitName, loader);
+            break;
+        }
+
+        loader.Finish();
+    }
+
+    bool LoadListingFile(const std::string& path, DebugInfo& info, const LoadOptions& options) {
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+        LoadListing(file.Data(), path, info, options);
+        return true;
+    }
+
+} // namespace stabs
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    class LinkerMap;
+    class LsymCache;
+
+    // Which tables to load. Each profile parses with its own grammar instantiation, so skipped
+    // tables cost (almost) nothing.
+    enum class CaptureProfile : uint8_t {
+        Full,
+        LineTable, // Line table only: N_SOL, N_SLINE and instruction addresses
+        Symbols,   // Section symbols, labels and function ranges only
+    };
+
+    // How N_LSYM strings that aren't cached yet are decoded
+    enum class LsymParser : uint8_t {
+        Grammar, // The lsym rules of the listing grammar
+        Tokens,  // Lexed once, then decoded from tokens; strings it rejects go to the grammar
+    };
+
+    // What the loaded text is
+    enum class InputFormat : uint8_t {
+        Listing, // Assembler listing: addresses of labels and instructions are in the text
+        // Compiler output (.s): stabs and labels without addresses. Labels are joined to the
+        // linker map for addresses; local labels aren't in the map, so there are no line
+        // entries or scope ranges, and functions extend to the next symbol of the map. The map
+        // only has globals: static functions and statics get no address, and a function
+        // followed by the code of a static one gets an unknown (empty) range. Capture profiles
+        // don't apply; all stabs are read.
+        Assembly,
+    };
+
+    struct LoadOptions {
+        // Bank that the listing's code and data are mapped in
+        BankId bank = 0;
+        CaptureProfile profile = CaptureProfile::Full;
+        LsymParser lsymParser = LsymParser::Grammar;
+        // Decoded N_LSYM strings shared between loads; LsymCache::Shared() if not set
+        LsymCache* lsymCache = nullptr;
+        InputFormat format = InputFormat::Listing;
+        // Assembly: map of the link the unit is part of
+        const LinkerMap* linkerMap = nullptr;
+    };
+
+    // Parses the stabs in a listing (or compiler output, see InputFormat) and appends them to
+    // info as a new compile unit. Run ComputeStackDepths (stack_depth.h) once the last unit is
+    // loaded, for the stack use of the functions.
+    void LoadListing(std::string_view text, const std::string& unitName, DebugInfo& info,
+                     const LoadOptions& options = {});
+
+    // Returns false if the file could not be read
+    bool LoadListingFile(const std::string& path, DebugInfo& info,
+                         const LoadOptions& options = {});
+
+} // namespace stabs
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#include "char_class.h"
+
+namespace stabs {
+
+    // Helpers for tools that scan listing lines without running the grammar, e.g. to index a
+    // listing before (or instead of) loading it
+
+    using ScanBlankSet = CharSet<' ', ' ', '\t', '\t'>;
+    using ScanHexSet = CharSet<'0', '9', 'A', 'F', 'a', 'f'>;
+
+    inline std::string_view SkipBlanks(std::string_view s) {
+        return s.substr(ScanBlankSet::Span(s.data(), s.data() + s.size()));
+    }
+
+    // The 4 hex digit address that instruction and label lines start with. On success, line is
+    // left at the text after the address.
+    inline bool ParseLineAddress(std::string_view& line, uint32_t& address) {
+        line = SkipBlanks(line);
+        if (line.size() < 5 || ScanHexSet::Span(line.data(), line.data() + 4) != 4 ||
+            !ScanBlankSet::Contains(line[4]))
+            return false;
+        std::from_chars(line.data(), line.data() + 4, address, 16);
+        line.remove_prefix(5);
+        return true;
+    }
+
+    // Instruction lines have the cycle count in brackets after the bytes: "[ 5]". rest is the
+    // text after the address.
+    inline bool IsInstruction(std::string_view rest) {
+        const size_t open = rest.find('[');
+        return open != std::string_view::npos && open + 3 < rest.size() && rest[open + 3] == ']';
+    }
+
+    // Bytes of an instruction: the hex digit pairs before the cycle count
+    inline uint32_t InstructionSize(std::string_view rest) {
+        uint32_t hexDigits = 0;
+        for (char c : rest.substr(0, rest.find('[')))
+            hexDigits += ScanHexSet::Contains(c) ? 1 : 0;
+        return hexDigits / 2;
+    }
+
+} // namespace stabs
@@ -0,0 +1,85 @@
+#include "listing_text.h"
+
+#include <cstring>
+#include <limits>
+
+#include "char_class.h"
+#include "listing_scan.h"
+
+namespace stabs {
+
+    ListingTextIndex::BankTables::BankTables()
+        : offset(AddressSpaceSize, InvalidIndex)
+        , file(AddressSpaceSize, 0) {}
+
+    bool ListingTextIndex::AddListing(const std::string& path, BankId bank) {
+        if (m_files.size() > std::numeric_limits<uint16_t>::max())
+            return false;
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+
+        const uint16_t fileIndex = static_cast<uint16_t>(m_files.size());
+        const std::string_view data = file.Data();
+        auto& tables = m_banks[bank];
+
+        size_t begin = 0;
+        while (begin < data.size()) {
+            size_t eol = data.find('\n', begin);
+            if (eol == std::string_view::npos)
+                eol = data.size();
+            std::string_view rest = data.substr(begin, eol - begin);
+            begin = eol + 1;
+
+            uint32_t address = 0;
+            if (!ParseLineAddress(rest, address) || !IsInstruction(rest))
+                continue;
+            if (!tables)
+                tables = std::make_unique<BankTables>();
+            // Listings with the same code (e.g. a header's inline functions): first one wins
+            if (tables->offset[address] == InvalidIndex) {
+                const std::string_view text = SkipBlanks(rest);
+                tables->offset[address] = static_cast<uint32_t>(text.data() - data.data());
+                tables->file[address] = fileIndex;
+            }
+        }
+
+        m_files.push_back({path, std::move(file)});
+        return true;
+    }
+
+    std::string_view ListingTextIndex::Find(BankId bank, uint32_t address) const {
+        const BankTables* tables = Tables(bank, address);
+        if (!tables)
+            return {};
+        const std::string_view data = m_files[tables->file[address]].file.Data();
+        const char* begin = data.data() + tables->offset[address];
+        const char* end = data.data() + data.size();
+        if (const void* eol = std::memchr(begin, '\n', static_cast<size_t>(end - begin)))
+            end = static_cast<const char*>(eol);
+        if (end != begin && end[-1] == '\r')
+            --end;
+        return {begin, static_cast<size_t>(end - begin)};
+    }
+
+    std::string_view ListingTextIndex::InstructionText(std::string_view line) {
+        const size_t cycles = line.find(']');
+        if (cycles == std::string_view::npos)
+            return line;
+        std::string_view rest = SkipBlanks(line.substr(cycles + 1));
+        rest.remove_prefix(DigitSet::Span(rest.data(), rest.data() + rest.size()));
+        return SkipBlanks(rest);
+    }
+
+    std::string_view ListingTextIndex::ListingPath(BankId bank, uint32_t address) const {
+        const BankTables* tables = Tables(bank, address);
+        return tables ? std::string_view(m_files[tables->file[address]].path) : std::string_view();
+    }
+
+    void ListingTextIndex::Clear() {
+        for (auto& tables : m_banks)
+            tables.reset();
+        m_files.clear();
+    }
+
+} // namespace stabs
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "debug_info.h"
+#include "mapped_file.h"
+
+namespace stabs {
+
+    // The compiler's own text of the instruction at each (bank, address), straight from the
+    // mapped listings, for disassembly views that shouldn't re-disassemble. Each bank with code
+    // gets a dense 64K table of offsets into the listing that covers the address, and of which
+    // listing that is, so a lookup is two array reads.
+    class ListingTextIndex {
+    public:
+        // Maps the listing and indexes its instruction lines. Returns false if the file could not
+        // be read.
+        bool AddListing(const std::string& path, BankId bank = 0);
+
+        // The line of the instruction at address, from the text after the address to the end of
+        // the line, or empty if no listing has an instruction there:
+        //   "AE E4         [ 5]  126 \tldx\t,s\t; tmp33, dest"
+        std::string_view Find(BankId bank, uint32_t address) const;
+
+        // The instruction and its comment, without the bytes, cycles and line number:
+        //   "ldx\t,s\t; tmp33, dest"
+        static std::string_view InstructionText(std::string_view line);
+
+        // Path of the listing an instruction comes from, or empty
+        std::string_view ListingPath(BankId bank, uint32_t address) const;
+
+        void Clear();
+
+    private:
+        struct BankTables {
+            BankTables();
+            std::vector<uint32_t> offset; // Start of the text after the address
+            std::vector<uint16_t> file;   // Index into m_files
+        };
+
+        struct Listing {
+            std::string path;
+            MappedFile file;
+        };
+
+        const BankTables* Tables(BankId bank, uint32_t address) const {
+            const BankTables* tables = m_banks[bank].get();
+            return tables && address < AddressSpaceSize && tables->offset[address] != InvalidIndex
+                       ? tables
+                       : nullptr;
+        }
+
+        std::vector<Listing> m_files;
+        std::array<std::unique_ptr<BankTables>, MaxBanks> m_banks;
+    };
+
+} // namespace stabs
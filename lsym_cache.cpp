@@ -0,0 +1,140 @@
+#include "lsym_cache.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace stabs {
+    namespace {
+        bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+        bool IsLetter(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+        // Whether the digits (or '-') at pos start a number rather than continue a name
+        bool StartsNumber(std::string_view s, size_t pos) {
+            if (pos == 0)
+                return false;
+            const char prev = s[pos - 1];
+            if (prev == ':' || prev == '=' || prev == ';' || prev == ',' || prev == '*' ||
+                prev == '!' || prev == '#' || prev == '%')
+                return true;
+            // C++ member visibility digit: the "/2" of "a:/27,0,16;"
+            if (IsDigit(prev) && pos >= 2 && s[pos - 2] == '/')
+                return true;
+            if (!IsLetter(prev))
+                return false;
+
+            // Type descriptor letters right after ':' or '=' ("t7", "ar26", "s4", "k7"). Any
+            // other letters belong to a name ("var1", the "a2" member in "s4a2:7").
+            size_t begin = pos - 1;
+            while (begin > 0 && IsLetter(s[begin - 1]))
+                --begin;
+            if (begin == 0 || (s[begin - 1] != ':' && s[begin - 1] != '='))
+                return false;
+            const std::string_view letters = s.substr(begin, pos - begin);
+            return letters == "t" || letters == "T" || letters == "Tt" || letters == "r" ||
+                   letters == "R" || letters == "ar" || letters == "s" || letters == "u" ||
+                   letters == "k" || letters == "B" || letters == "f";
+        }
+    } // namespace
+
+    void NormalizeLsym(std::string_view lsym, std::string& key,
+                       std::vector<std::string_view>& numbers) {
+        key.clear();
+        numbers.clear();
+        size_t literal = 0;
+        for (size_t i = 0; i < lsym.size();) {
+            const bool sign = lsym[i] == '-' && i + 1 < lsym.size() && IsDigit(lsym[i + 1]);
+            if ((sign || IsDigit(lsym[i])) && StartsNumber(lsym, i)) {
+                size_t end = sign ? i + 1 : i;
+                while (end < lsym.size() && IsDigit(lsym[end]))
+                    ++end;
+                key.append(lsym.data() + literal, i - literal);
+                key += '#';
+                numbers.push_back(lsym.substr(i, end - i));
+                i = literal = end;
+            } else {
+                ++i;
+            }
+        }
+        key.append(lsym.data() + literal, lsym.size() - literal);
+    }
+
+    bool CheckLsymNumbers(const LsymRecord& record, const std::vector<std::string_view>& numbers) {
+        auto number = [&](NumberSlot slot) {
+            return slot < numbers.size() ? numbers[slot] : std::string_view();
+        };
+        for (auto& base : record.bases) {
+            const std::string_view spec = number(base.spec);
+            if (spec.size() < 3 || (spec[0] != '0' && spec[0] != '1') || spec[1] < '0' ||
+                spec[1] > '2' || !std::all_of(spec.begin(), spec.end(), IsDigit))
+                return false;
+        }
+        for (auto& method : record.methods) {
+            const std::string_view access = number(method.access);
+            if (access.size() != 1 || access[0] < '0' || access[0] > '2')
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<std::string_view>::iterator LsymSlots::FindNormalized(const char* p) {
+        return std::lower_bound(
+            m_numbers.begin(), m_numbers.begin() + m_numNormalized, p,
+            [](std::string_view number, const char* q) { return number.data() < q; });
+    }
+
+    NumberSlot LsymSlots::SlotOf(std::string_view number) {
+        const auto end = m_numbers.begin() + m_numNormalized;
+        const auto it = FindNormalized(number.data());
+        if (it != end && it->data() == number.data() && it->size() == number.size())
+            return static_cast<NumberSlot>(it - m_numbers.begin());
+
+        m_cacheable = false;
+        if (m_numbers.size() >= NoSlot)
+            return NoSlot;
+        m_numbers.push_back(number);
+        return static_cast<NumberSlot>(m_numbers.size() - 1);
+    }
+
+    std::string LsymSlots::NameOf(std::string_view name) {
+        // Otherwise every string of this shape would get this name
+        const auto it = FindNormalized(name.data());
+        if (it != m_numbers.begin() + m_numNormalized && it->data() < name.data() + name.size())
+            m_cacheable = false;
+        return std::string(name);
+    }
+
+    std::shared_ptr<const LsymRecord> LsymCache::Find(const std::string& key) const {
+        const Shard& shard = ShardFor(key);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.records.find(key);
+        return it != shard.records.end() ? it->second : nullptr;
+    }
+
+    void LsymCache::Insert(const std::string& key, std::shared_ptr<const LsymRecord> record) {
+        Shard& shard = ShardFor(key);
+        std::unique_lock lock(shard.mutex);
+        shard.records.try_emplace(key, std::move(record));
+    }
+
+    size_t LsymCache::Size() const {
+        size_t size = 0;
+        for (const Shard& shard : m_shards) {
+            std::shared_lock lock(shard.mutex);
+            size += shard.records.size();
+        }
+        return size;
+    }
+
+    void LsymCache::Clear() {
+        for (Shard& shard : m_shards) {
+            std::unique_lock lock(shard.mutex);
+            shard.records.clear();
+        }
+    }
+
+    LsymCache& LsymCache::Shared() {
+        static LsymCache cache;
+        return cache;
+    }
+
+} // namespace stabs
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace stabs {
+
+    // Index into the numbers of an lsym string (see NormalizeLsym)
+    using NumberSlot = uint16_t;
+    constexpr NumberSlot NoSlot = 0xFFFF;
+
+    // Decoded N_LSYM string. Numbers (type ids, sizes, offsets, enum values) are stored as slots
+    // into the numbers of the string they were decoded from, so every string with the same shape
+    // shares one record.
+    struct LsymRecord {
+        // "int:t7" typedef, "Foo:T26" struct/union/enum tag, "Foo:Tt26" both (C++), "a:7" local
+        enum class Kind : uint8_t { TypeDef, Tag, TagTypeDef, Variable };
+
+        // Definition of a type number, e.g. the "25=*7" of "p:25=*7". Types are referred to by
+        // number, whether or not the unit has defined them yet.
+        struct TypeDesc {
+            enum class Kind : uint8_t {
+                Alias,    // "26=7"
+                Range,    // "13=r13;0;255;"
+                Pointer,  // "25=*7"
+                Const,    // "26=k7"
+                Volatile, // "26=B7"
+                Function, // "26=f7", or a method "26=##7;"
+                Array,    // "25=ar26;0;9;7"
+                Enum,     // "22=eFalse:0,True:1,;"
+                Struct,   // "26=s4a:7,0,16;;"
+                Union,    // "26=u2a:7,0,16;b:13,0,8;;"
+                CrossRef, // "26=xsFoo:", a struct, union or enum by name
+            };
+
+            Kind kind = Kind::Alias;
+            NumberSlot id = NoSlot;
+            NumberSlot target = NoSlot;                          // Type the descriptor applies to
+            NumberSlot lowerBound = NoSlot, upperBound = NoSlot; // Range, Array index
+            NumberSlot byteSize = NoSlot;                        // Struct, Union
+            char tag = 0;                                        // CrossRef: 's', 'u' or 'e'
+            std::string name;                                    // CrossRef
+            uint32_t first = 0, count = 0;                       // Members, or Enum values
+            uint32_t firstBase = 0, numBases = 0;                // Struct, Union
+            uint32_t firstMethod = 0, numMethods = 0;            // Struct, Union
+        };
+
+        struct Member {
+            std::string name;
+            NumberSlot type = NoSlot;
+            NumberSlot bitOffset = NoSlot;
+            NumberSlot bitSize = NoSlot;
+        };
+
+        struct Value {
+            std::string name;
+            NumberSlot value = NoSlot;
+        };
+
+        // "020,26;": virtual flag, access and bit offset are one number ("020")
+        struct Base {
+            NumberSlot spec = NoSlot;
+            NumberSlot type = NoSlot;
+        };
+
+        // One overload: "26=##7;:_ZN3Foo3getEv;2A."
+        struct Method {
+            std::string name;
+            std::string physName;
+            NumberSlot type = NoSlot;
+            NumberSlot access = NoSlot; // '0' private, '1' protected, '2' public
+            bool isVirtual = false;
+            bool isStatic = false;
+        };
+
+        Kind kind = Kind::Variable;
+        std::string name;
+        NumberSlot type = NoSlot;
+        std::vector<TypeDesc> types; // Every definition in the string, innermost first
+        std::vector<Member> members;
+        std::vector<Value> values;
+        std::vector<Base> bases;
+        std::vector<Method> methods;
+    };
+
+    // Replaces every number of an lsym string that isn't part of a name with '#', and returns
+    // the numbers in order:
+    //   "bool:t22=eFalse:0,True:1,;" -> "bool:t#=eFalse:#,True:#,;" {22, 0, 1}
+    void NormalizeLsym(std::string_view lsym, std::string& key,
+                       std::vector<std::string_view>& numbers);
+
+    // Whether the numbers of a string fit the slots of its record that the grammar restricts:
+    // base class specs ("020": virtual flag 0-1, access 0-2, then the offset) and method access
+    // digits (0-2). NormalizeLsym replaces these like any other number, so a cache hit has to
+    // check them to reject what the grammar would.
+    bool CheckLsymNumbers(const LsymRecord& record, const std::vector<std::string_view>& numbers);
+
+    // Slots of the numbers of a string being decoded into an LsymRecord. Numbers are looked up
+    // among the ones NormalizeLsym replaced. Any other number is added for this string only and
+    // makes the record uncacheable, as does a replaced number inside a name.
+    class LsymSlots {
+    public:
+        // numbers: from NormalizeLsym if cacheable, otherwise empty
+        LsymSlots(std::vector<std::string_view>& numbers, bool cacheable)
+            : m_numbers(numbers)
+            , m_numNormalized(numbers.size())
+            , m_cacheable(cacheable) {}
+
+        NumberSlot SlotOf(std::string_view number);
+        std::string NameOf(std::string_view name);
+
+        bool Cacheable() const { return m_cacheable; }
+
+    private:
+        std::vector<std::string_view>::iterator FindNormalized(const char* p);
+
+        std::vector<std::string_view>& m_numbers;
+        const size_t m_numNormalized;
+        bool m_cacheable;
+    };
+
+    // Decoded lsym records keyed by normalized string. Every unit that includes a header emits
+    // the same strings with different type numbers, so most units only decode strings they
+    // share with a unit that was loaded before. Safe to share between loading threads.
+    class LsymCache {
+    public:
+        std::shared_ptr<const LsymRecord> Find(const std::string& key) const;
+        // Keeps the existing record if another thread inserted the key first
+        void Insert(const std::string& key, std::shared_ptr<const LsymRecord> record);
+
+        size_t Size() const;
+        void Clear();
+
+        // Used by loads that don't pass their own cache
+        static LsymCache& Shared();
+
+    private:
+        static constexpr size_t NumShards = 16;
+
+        struct Shard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<std::string, std::shared_ptr<const LsymRecord>> records;
+        };
+
+        Shard& ShardFor(const std::string& key) const {
+            return m_shards[std::hash<std::string>{}(key) % NumShards];
+        }
+
+        mutable std::array<Shard, NumShards> m_shards;
+    };
+
+} // namespace stabs
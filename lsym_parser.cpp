@@ -0,0 +1,398 @@
+#include "lsym_parser.h"
+
+#include <iterator>
+
+#include "char_class.h"
+
+namespace stabs {
+    namespace {
+        bool IsIdentifier(std::string_view name) {
+            return !name.empty() && IdentifierFirstSet::Contains(name[0]) &&
+                   IdentifierOtherSet::Span(name.data(), name.data() + name.size()) == name.size();
+        }
+
+        // struct_member_name, method_name: anything up to the ':' but a ';' or ','
+        bool IsMemberName(std::string_view name) {
+            return !name.empty() && name.find_first_of(";,") == std::string_view::npos;
+        }
+
+        std::string_view TrimRight(std::string_view sv) {
+            while (!sv.empty() && (sv.back() == ' ' || sv.back() == '\t'))
+                sv.remove_suffix(1);
+            return sv;
+        }
+
+        // Recursive descent over the tokens, one function per rule of the lsym grammar
+        class TokenParser {
+        public:
+            TokenParser(std::string_view text, const std::vector<LsymToken>& tokens,
+                        LsymSlots& slots, LsymRecord& record)
+                : m_text(text)
+                , m_tokens(tokens)
+                , m_slots(slots)
+                , m_record(record) {}
+
+            // lsym: tag_def, type_def or variable. All of them start with "<name>:", and the
+            // word after the ':' tells them apart.
+            bool Parse() {
+                const std::string_view name = NameBeforeColon(Peek().begin);
+                if (!Punct(':'))
+                    return false;
+
+                if (Word("t"))
+                    m_record.kind = LsymRecord::Kind::TypeDef;
+                else if (Word("T"))
+                    m_record.kind = LsymRecord::Kind::Tag;
+                else if (Word("Tt"))
+                    m_record.kind = LsymRecord::Kind::TagTypeDef;
+                else
+                    m_record.kind = LsymRecord::Kind::Variable;
+
+                if (m_record.kind == LsymRecord::Kind::Variable ? !IsIdentifier(name)
+                                                                : name.empty())
+                    return false;
+                m_record.name = m_slots.NameOf(TrimRight(name));
+                return TypeRef(m_record.type) && End();
+            }
+
+        private:
+            const LsymToken& Peek(size_t offset = 0) const {
+                const size_t pos = m_pos + offset;
+                return pos < m_tokens.size() ? m_tokens[pos] : m_tokens.back();
+            }
+
+            std::string_view Text(const LsymToken& token) const {
+                return m_text.substr(token.begin, token.length);
+            }
+
+            bool AtPunct(char c) const {
+                return Peek().kind == LsymTokenKind::Punct && Peek().punct == c;
+            }
+
+            bool Punct(char c) {
+                if (!AtPunct(c))
+                    return false;
+                ++m_pos;
+                return true;
+            }
+
+            bool Word(std::string_view word) {
+                if (Peek().kind != LsymTokenKind::Word || Text(Peek()) != word)
+                    return false;
+                ++m_pos;
+                return true;
+            }
+
+            bool Number(NumberSlot& slot) {
+                if (Peek().kind != LsymTokenKind::Number)
+                    return false;
+                slot = m_slots.SlotOf(Text(Peek()));
+                ++m_pos;
+                return true;
+            }
+
+            // A number the grammar doesn't capture
+            bool SkipNumber() {
+                if (Peek().kind != LsymTokenKind::Number)
+                    return false;
+                ++m_pos;
+                return true;
+            }
+
+            bool End() const { return Peek().kind == LsymTokenKind::End; }
+
+            // Text from begin up to the next ':', which is left as the current token
+            std::string_view NameBeforeColon(uint32_t begin) {
+                while (!End() && !AtPunct(':'))
+                    ++m_pos;
+                return m_text.substr(begin, Peek().begin - begin);
+            }
+
+            // type_ref: "7", or "25=*7"
+            bool TypeRef(NumberSlot& id) { return Number(id) && Definition(id); }
+
+            // The optional "=<type_desc>" of a type_ref
+            bool Definition(NumberSlot id) { return !Punct('=') || TypeDesc(id); }
+
+            bool TypeDesc(NumberSlot id) {
+                LsymRecord::TypeDesc desc;
+                desc.id = id;
+                if (!TypeDescBody(desc))
+                    return false;
+                // Nested definitions were added first
+                m_record.types.push_back(std::move(desc));
+                return true;
+            }
+
+            bool TypeDescBody(LsymRecord::TypeDesc& desc) {
+                using Kind = LsymRecord::TypeDesc::Kind;
+                const LsymToken& token = Peek();
+                if (token.kind == LsymTokenKind::Number) {
+                    desc.kind = Kind::Alias;
+                    return TypeRef(desc.target);
+                }
+                if (Punct('*')) {
+                    desc.kind = Kind::Pointer;
+                    return TypeRef(desc.target);
+                }
+                if (AtPunct('#'))
+                    return MethodType(desc);
+                if (token.kind != LsymTokenKind::Word)
+                    return false;
+
+                const std::string_view word = Text(token);
+                if (Word("k") || Word("B") || Word("f")) {
+                    desc.kind = word == "k" ? Kind::Const : word == "B" ? Kind::Volatile
+                                                                        : Kind::Function;
+                    return TypeRef(desc.target);
+                }
+                if (Word("r") || Word("R")) {
+                    // "r13;0;255;"
+                    desc.kind = Kind::Range;
+                    NumberSlot rangeOf = NoSlot;
+                    return TypeRef(rangeOf) && Punct(';') && Number(desc.lowerBound) &&
+                           Punct(';') && Number(desc.upperBound) && Punct(';');
+                }
+                if (Word("ar")) {
+                    // "ar26=r26;0;-1;;0;9;7"
+                    desc.kind = Kind::Array;
+                    NumberSlot index = NoSlot;
+                    return TypeRef(index) && Punct(';') && Number(desc.lowerBound) &&
+                           Punct(';') && Number(desc.upperBound) && Punct(';') &&
+                           TypeRef(desc.target);
+                }
+                if (word == "s" || word == "u")
+                    return Aggregate(desc);
+                if (word[0] == 'e')
+                    return Enum(desc);
+                if (word[0] == 'x' && word.size() > 1 &&
+                    (word[1] == 's' || word[1] == 'u' || word[1] == 'e')) {
+                    // "xsFoo:"; the name starts in the same word
+                    desc.kind = Kind::CrossRef;
+                    desc.tag = word[1];
+                    const std::string_view name = NameBeforeColon(token.begin + 2);
+                    if (name.empty() || !Punct(':'))
+                        return false;
+                    desc.name = m_slots.NameOf(name);
+                    return true;
+                }
+                return false;
+            }
+
+            // "##7;", or "#27,7,27,13;" with the class and argument types
+            bool MethodType(LsymRecord::TypeDesc& desc) {
+                desc.kind = LsymRecord::TypeDesc::Kind::Function;
+                Punct('#');
+                if (Punct('#')) {
+                    if (!TypeRef(desc.target))
+                        return false;
+                } else {
+                    NumberSlot owner = NoSlot;
+                    if (!TypeRef(owner) || !Punct(',') || !TypeRef(desc.target))
+                        return false;
+                    while (Punct(',')) {
+                        NumberSlot argument = NoSlot;
+                        if (!TypeRef(argument))
+                            return false;
+                    }
+                }
+                return Punct(';');
+            }
+
+            // "eFalse:0,True:1,;"
+            bool Enum(LsymRecord::TypeDesc& desc) {
+                desc.kind = LsymRecord::TypeDesc::Kind::Enum;
+                desc.first = static_cast<uint32_t>(m_record.values.size());
+
+                // The first value's name shares a word with the 'e'
+                uint32_t valueBegin = Peek().begin + 1;
+                do {
+                    LsymRecord::Value value;
+                    const std::string_view valueName = NameBeforeColon(valueBegin);
+                    if (!IsIdentifier(valueName) || !Punct(':') || !Number(value.value) ||
+                        !Punct(','))
+                        return false;
+                    value.name = m_slots.NameOf(valueName);
+                    m_record.values.push_back(std::move(value));
+                    valueBegin = Peek().begin;
+                } while (!AtPunct(';'));
+                ++m_pos;
+                desc.count = static_cast<uint32_t>(m_record.values.size()) - desc.first;
+                return true;
+            }
+
+            // "s4a:7,0,8;b:7,8,8;;", "s6!1,020,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;"
+            bool Aggregate(LsymRecord::TypeDesc& desc) {
+                desc.kind = Text(Peek()) == "s" ? LsymRecord::TypeDesc::Kind::Struct
+                                                : LsymRecord::TypeDesc::Kind::Union;
+                ++m_pos;
+                if (!Number(desc.byteSize))
+                    return false;
+
+                // Members may define structs of their own, so this one's are added at the end
+                std::vector<LsymRecord::Base> bases;
+                std::vector<LsymRecord::Member> members;
+                std::vector<LsymRecord::Method> methods;
+                if (Punct('!') && !BaseClasses(bases))
+                    return false;
+
+                while (!AtPunct(';')) {
+                    const std::string_view name = NameBeforeColon(Peek().begin);
+                    if (!IsMemberName(name) || !Punct(':'))
+                        return false;
+                    if (Punct(':')) {
+                        if (!Method(name, methods))
+                            return false;
+                        continue;
+                    }
+                    // Fields come before member functions
+                    if (!methods.empty() || !Member(name, members))
+                        return false;
+                }
+                ++m_pos;
+
+                // "~%27;"
+                if (Punct('~')) {
+                    NumberSlot holder = NoSlot;
+                    if (!Punct('%') || !TypeRef(holder) || !Punct(';'))
+                        return false;
+                }
+
+                desc.firstBase = static_cast<uint32_t>(m_record.bases.size());
+                desc.numBases = static_cast<uint32_t>(bases.size());
+                desc.first = static_cast<uint32_t>(m_record.members.size());
+                desc.count = static_cast<uint32_t>(members.size());
+                desc.firstMethod = static_cast<uint32_t>(m_record.methods.size());
+                desc.numMethods = static_cast<uint32_t>(methods.size());
+                std::move(bases.begin(), bases.end(), std::back_inserter(m_record.bases));
+                std::move(members.begin(), members.end(), std::back_inserter(m_record.members));
+                std::move(methods.begin(), methods.end(), std::back_inserter(m_record.methods));
+                return true;
+            }
+
+            // "1,020,26;" after the '!'
+            bool BaseClasses(std::vector<LsymRecord::Base>& bases) {
+                if (!SkipNumber() || !Punct(','))
+                    return false;
+                do {
+                    // Virtual flag, access and offset are one number token
+                    const std::string_view spec = Text(Peek());
+                    if (Peek().kind != LsymTokenKind::Number || spec.size() < 3 ||
+                        (spec[0] != '0' && spec[0] != '1') || spec[1] < '0' || spec[1] > '2')
+                        return false;
+                    LsymRecord::Base base;
+                    Number(base.spec);
+                    if (!Punct(',') || !TypeRef(base.type) || !Punct(';'))
+                        return false;
+                    bases.push_back(base);
+                } while (Peek().kind == LsymTokenKind::Number);
+                return true;
+            }
+
+            // "a:7,0,8;", or "c:/213,32,8;" with C++ visibility; the name and ':' are read
+            bool Member(std::string_view name, std::vector<LsymRecord::Member>& members) {
+                LsymRecord::Member member;
+                if (Punct('/')) {
+                    // The visibility digit and the type number are one token
+                    const std::string_view number = Text(Peek());
+                    if (Peek().kind != LsymTokenKind::Number || number.size() < 2 ||
+                        (number[0] != '0' && number[0] != '1' && number[0] != '2' &&
+                         number[0] != '9'))
+                        return false;
+                    member.type = m_slots.SlotOf(number.substr(1));
+                    ++m_pos;
+                    if (!Definition(member.type))
+                        return false;
+                } else if (!TypeRef(member.type)) {
+                    return false;
+                }
+                if (!Punct(',') || !Number(member.bitOffset) || !Punct(',') ||
+                    !Number(member.bitSize) || !Punct(';'))
+                    return false;
+                member.name = m_slots.NameOf(name);
+                members.push_back(std::move(member));
+                return true;
+            }
+
+            // "get::28=##7;:_ZN3Bar3getEv;2A.;" after the "::", one overload per variant
+            bool Method(std::string_view name, std::vector<LsymRecord::Method>& methods) {
+                do {
+                    LsymRecord::Method method;
+                    method.name = m_slots.NameOf(name);
+                    if (!TypeRef(method.type) || !Punct(':'))
+                        return false;
+
+                    const uint32_t physBegin = Peek().begin;
+                    while (!End() && !AtPunct(';'))
+                        ++m_pos;
+                    const std::string_view physName =
+                        m_text.substr(physBegin, Peek().begin - physBegin);
+                    if (physName.empty() || !Punct(';'))
+                        return false;
+                    method.physName = m_slots.NameOf(physName);
+
+                    // Access digit and qualifier letter: "2A"
+                    const std::string_view access = Text(Peek());
+                    if (Peek().kind != LsymTokenKind::Number || access.size() != 1 ||
+                        access[0] > '2' || !Number(method.access))
+                        return false;
+                    if (!(Word("A") || Word("B") || Word("C") || Word("D")))
+                        return false;
+
+                    if (Punct('*')) {
+                        NumberSlot owner = NoSlot;
+                        if (!SkipNumber() || !Punct(';') || !TypeRef(owner) || !Punct(';'))
+                            return false;
+                        method.isVirtual = true;
+                    } else if (Punct('?')) {
+                        method.isStatic = true;
+                    } else if (!Punct('.')) {
+                        return false;
+                    }
+                    methods.push_back(std::move(method));
+                } while (!AtPunct(';'));
+                ++m_pos;
+                return true;
+            }
+
+            std::string_view m_text;
+            const std::vector<LsymToken>& m_tokens;
+            LsymSlots& m_slots;
+            LsymRecord& m_record;
+            size_t m_pos = 0;
+        };
+
+    } // namespace
+
+    void LexLsym(std::string_view lsym, std::vector<LsymToken>& tokens) {
+        tokens.clear();
+        const char* end = lsym.data() + lsym.size();
+        size_t i = 0;
+        while (i < lsym.size()) {
+            const size_t begin = i;
+            LsymToken token{LsymTokenKind::Punct, 0, static_cast<uint32_t>(begin), 0};
+            if (IdentifierFirstSet::Contains(lsym[i])) {
+                token.kind = LsymTokenKind::Word;
+                ++i;
+                i += IdentifierFirstSet::Span(lsym.data() + i, end);
+            } else if (DigitSet::Contains(lsym[i]) ||
+                       (lsym[i] == '-' && i + 1 < lsym.size() && DigitSet::Contains(lsym[i + 1]))) {
+                token.kind = LsymTokenKind::Number;
+                ++i;
+                i += DigitSet::Span(lsym.data() + i, end);
+            } else {
+                token.punct = lsym[i];
+                ++i;
+            }
+            token.length = static_cast<uint32_t>(i - begin);
+            tokens.push_back(token);
+        }
+        tokens.push_back({LsymTokenKind::End, 0, static_cast<uint32_t>(lsym.size()), 0});
+    }
+
+    bool ParseLsymTokens(std::string_view lsym, const std::vector<LsymToken>& tokens,
+                         LsymSlots& slots, LsymRecord& record) {
+        return TokenParser(lsym, tokens, slots, record).Parse();
+    }
+
+} // namespace stabs
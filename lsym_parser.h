@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "lsym_cache.h"
+
+namespace stabs {
+
+    enum class LsymTokenKind : uint8_t {
+        Word,   // Letters and '_': "int", the 't' of ":t7", "eFalse" of "=eFalse:0"
+        Number, // Digits with an optional '-'
+        Punct,  // Any other single character
+        End,
+    };
+
+    struct LsymToken {
+        LsymTokenKind kind;
+        char punct; // Punct only
+        uint32_t begin;
+        uint32_t length;
+    };
+
+    // Splits an lsym string (the contents of the quotes) into tokens, followed by an End token.
+    // Runs of letters and digits are scanned with CharSet::Span.
+    void LexLsym(std::string_view lsym, std::vector<LsymToken>& tokens);
+
+    // Decodes the tokens of an lsym string. Accepts the same strings as the lsym grammar rule and
+    // returns false for anything else, which is then left to the grammar.
+    bool ParseLsymTokens(std::string_view lsym, const std::vector<LsymToken>& tokens,
+                         LsymSlots& slots, LsymRecord& record);
+
+} // namespace stabs
@@ -0,0 +1,118 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stabs {
+
+    MappedFile::MappedFile(MappedFile&& rhs) noexcept { Swap(rhs); }
+
+    MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    void MappedFile::Swap(MappedFile& rhs) noexcept {
+        std::swap(m_data, rhs.m_data);
+        std::swap(m_size, rhs.m_size);
+        std::swap(m_open, rhs.m_open);
+#ifdef _WIN32
+        std::swap(m_file, rhs.m_file);
+        std::swap(m_mapping, rhs.m_mapping);
+#endif
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file = file;
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_open = true;
+        if (m_size == 0) // Empty files can't be mapped
+            return true;
+
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping)
+            m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file)
+            CloseHandle(m_file);
+        m_data = nullptr;
+        m_mapping = m_file = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+#else
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size > 0) {
+            void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                m_size = 0;
+                return false;
+            }
+            m_data = static_cast<const char*>(data);
+        }
+        // The mapping keeps the file alive
+        ::close(fd);
+        m_open = true;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (m_data)
+            ::munmap(const_cast<char*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+#endif
+
+} // namespace stabs
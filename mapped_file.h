@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace stabs {
+
+    // Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(MappedFile&& rhs) noexcept;
+        MappedFile& operator=(MappedFile&& rhs) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { Close(); }
+
+        bool Open(const std::string& path);
+        void Close();
+
+        bool IsOpen() const { return m_open; }
+        std::string_view Data() const { return {m_data, m_size}; }
+
+    private:
+        void Swap(MappedFile& rhs) noexcept;
+
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        bool m_open = false;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+
+} // namespace stabs
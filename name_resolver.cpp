@@ -0,0 +1,127 @@
+#include "name_resolver.h"
+
+namespace stabs {
+
+    NameResolver::NameResolver(const DebugInfo& info)
+        : m_info(info) {
+        const auto numBlocks = static_cast<uint32_t>(info.scopes.size());
+        const auto numUnits = static_cast<uint32_t>(info.units.size());
+        m_globalScope = numBlocks + numUnits;
+
+        std::vector<Entry> entries;
+        for (auto& scope : info.scopes) {
+            entries.clear();
+            for (uint32_t i = scope.firstVariable; i < scope.firstVariable + scope.numVariables;
+                 ++i) {
+                const Variable& var = info.variables[i];
+                if (var.symbol != InvalidIndex)
+                    entries.push_back({var.name, {BindingKind::Static, var.symbol}});
+                else
+                    entries.push_back({var.name, {BindingKind::Local, i}});
+            }
+            // A function's outermost block continues into the file scope
+            AddScope(scope.parent != InvalidIndex ? scope.parent : numBlocks + scope.unit, entries);
+        }
+
+        std::vector<std::vector<Entry>> fileEntries(numUnits);
+        std::vector<Entry> globalEntries;
+        for (uint32_t i = 0; i < info.symbols.size(); ++i) {
+            const Symbol& symbol = info.symbols[i];
+            if (symbol.kind == SymbolKind::FileStatic)
+                fileEntries[symbol.unit].push_back({symbol.name, {BindingKind::Static, i}});
+            else if (symbol.kind == SymbolKind::Function || symbol.kind == SymbolKind::Global)
+                globalEntries.push_back({symbol.name, {BindingKind::Static, i}});
+        }
+        for (auto& unitEntries : fileEntries)
+            AddScope(m_globalScope, unitEntries);
+        AddScope(InvalidIndex, globalEntries);
+
+        // Code outside of any block is in its unit's file scope. Parents precede children, so
+        // inner blocks overwrite their enclosing ones.
+        for (auto& function : info.functions) {
+            const uint32_t unitScope = numBlocks + info.symbols[function.symbol].unit;
+            auto& pcScopes = PcScopes(function.bank);
+            for (uint32_t pc = function.start; pc < function.end && pc < AddressSpaceSize; ++pc)
+                pcScopes[pc] = unitScope;
+        }
+        for (uint32_t s = 0; s < numBlocks; ++s) {
+            const Scope& scope = info.scopes[s];
+            if (scope.start == InvalidAddress || scope.end == InvalidAddress)
+                continue;
+            auto& pcScopes = PcScopes(info.units[scope.unit].bank);
+            for (uint32_t pc = scope.start; pc < scope.end && pc < AddressSpaceSize; ++pc)
+                pcScopes[pc] = s;
+        }
+    }
+
+    std::vector<uint32_t>& NameResolver::PcScopes(BankId bank) {
+        auto& pcScopes = m_pcScope[bank];
+        if (pcScopes.empty())
+            pcScopes.resize(AddressSpaceSize, InvalidIndex);
+        return pcScopes;
+    }
+
+    Binding NameResolver::Resolve(BankId bank, uint32_t pc, std::string_view name) {
+        // A name that was never interned can't be declared anywhere
+        const StrId id = m_info.strings.Find(name);
+        if (id == InvalidStrId)
+            return {};
+
+        const auto& pcScopes = m_pcScope[bank];
+        uint32_t scope = pc < pcScopes.size() ? pcScopes[pc] : InvalidIndex;
+        if (scope == InvalidIndex)
+            scope = m_globalScope;
+
+        const uint64_t key = uint64_t{scope} << 32 | id;
+        if (auto it = m_cache.find(key); it != m_cache.end())
+            return it->second;
+
+        Binding binding;
+        for (uint32_t s = scope; s != InvalidIndex; s = m_scopes[s].parent) {
+            binding = Lookup(s, id);
+            if (binding.kind != BindingKind::None)
+                break;
+        }
+        m_cache.emplace(key, binding);
+        return binding;
+    }
+
+    void NameResolver::AddScope(uint32_t parent, const std::vector<Entry>& entries) {
+        // Power of two with at least one free slot, at most half full
+        uint32_t size = 1;
+        while (size < entries.size() * 2)
+            size *= 2;
+
+        ScopeTable table;
+        table.parent = parent;
+        table.firstSlot = static_cast<uint32_t>(m_slots.size());
+        table.mask = size - 1;
+        m_slots.resize(m_slots.size() + size);
+
+        for (auto& entry : entries) {
+            for (uint32_t i = Hash(entry.name);; ++i) {
+                Slot& slot = m_slots[table.firstSlot + (i & table.mask)];
+                if (slot.name == entry.name)
+                    break; // Redeclared in the same scope: keep the first
+                if (slot.name == InvalidStrId) {
+                    slot.name = entry.name;
+                    slot.binding = entry.binding;
+                    break;
+                }
+            }
+        }
+        m_scopes.push_back(table);
+    }
+
+    Binding NameResolver::Lookup(uint32_t scope, StrId name) const {
+        const ScopeTable& table = m_scopes[scope];
+        for (uint32_t i = Hash(name);; ++i) {
+            const Slot& slot = m_slots[table.firstSlot + (i & table.mask)];
+            if (slot.name == name)
+                return slot.binding;
+            if (slot.name == InvalidStrId)
+                return {};
+        }
+    }
+
+} // namespace stabs
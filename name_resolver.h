@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    enum class BindingKind : uint8_t {
+        None,
+        Local,  // Index into DebugInfo::variables
+        Static, // Index into DebugInfo::symbols (function/file statics, globals, functions)
+    };
+
+    struct Binding {
+        BindingKind kind = BindingKind::None;
+        uint32_t index = InvalidIndex;
+    };
+
+    // Resolves identifiers the way C scoping does at a given PC: innermost block outwards, then
+    // the file statics of the unit, then globals. Every scope gets a small open-addressing table
+    // of its names and a link to its parent, so a lookup is a few probes up the chain. Results
+    // are cached per (innermost scope, name), i.e. per PC range. PCs are keyed by (bank, address).
+    //
+    // Built from a fully loaded DebugInfo; rebuild after reloading.
+    class NameResolver {
+    public:
+        explicit NameResolver(const DebugInfo& info);
+
+        Binding Resolve(BankId bank, uint32_t pc, std::string_view name);
+
+    private:
+        struct Slot {
+            StrId name = InvalidStrId;
+            Binding binding;
+        };
+
+        struct ScopeTable {
+            uint32_t parent = InvalidIndex;
+            uint32_t firstSlot = 0;
+            uint32_t mask = 0;
+        };
+
+        struct Entry {
+            StrId name;
+            Binding binding;
+        };
+
+        void AddScope(uint32_t parent, const std::vector<Entry>& entries);
+        Binding Lookup(uint32_t scope, StrId name) const;
+        std::vector<uint32_t>& PcScopes(BankId bank);
+        static uint32_t Hash(StrId name) {
+            uint32_t h = name * 0x9E3779B1u;
+            return h ^ (h >> 16);
+        }
+
+        const DebugInfo& m_info;
+        // Block scopes (same indices as DebugInfo::scopes), then one per unit for file statics,
+        // then the global scope.
+        std::vector<ScopeTable> m_scopes;
+        std::vector<Slot> m_slots;
+        uint32_t m_globalScope = InvalidIndex;
+        // Innermost scope for each address, for banks that have code
+        std::array<std::vector<uint32_t>, MaxBanks> m_pcScope;
+        std::unordered_map<uint64_t, Binding> m_cache;
+    };
+
+} // namespace stabs
@@ -0,0 +1,141 @@
+#include "parse_tree_dump.h"
+
+#include "buffered_writer.h"
+
+namespace stabs {
+
+    void ParseTreeDumper::Begin() {
+        m_trees = 0;
+        m_nextId = 0;
+        if (m_format == TreeFormat::Dot)
+            m_out.Write("digraph parse_tree {\n  node [shape=box];\n");
+        else if (m_format == TreeFormat::Json)
+            m_out.Put('[');
+    }
+
+    void ParseTreeDumper::End() {
+        if (m_format == TreeFormat::Dot)
+            m_out.Write("}\n");
+        else if (m_format == TreeFormat::Json)
+            m_out.Write(m_trees == 0 ? "]\n" : "\n]\n");
+    }
+
+    void ParseTreeDumper::Dump(const Node& root, uint64_t lineNumber) {
+        const uint64_t rootId = m_nextId++;
+        switch (m_format) {
+        case TreeFormat::Text:
+            if (!m_lineHeaders)
+                break;
+            m_out.Write("line ");
+            m_out.WriteUnsigned(lineNumber);
+            m_out.Put('\n');
+            break;
+        case TreeFormat::Dot:
+            m_out.Write("  subgraph cluster_");
+            m_out.WriteUnsigned(rootId);
+            m_out.Write(" {\n  n");
+            m_out.WriteUnsigned(rootId);
+            m_out.Write(" [label=\"line ");
+            m_out.WriteUnsigned(lineNumber);
+            m_out.Write("\"];\n");
+            break;
+        case TreeFormat::Json:
+            m_out.Write(m_trees == 0 ? "\n{\"line\": " : ",\n{\"line\": ");
+            m_out.WriteUnsigned(lineNumber);
+            m_out.Write(", \"children\": [");
+            break;
+        }
+        ++m_trees;
+
+        // The root has no content of its own; its children are the tops of the tree
+        m_stack.clear();
+        m_stack.push_back({&root, 0, rootId});
+        while (!m_stack.empty()) {
+            Visit& visit = m_stack.back();
+            if (visit.nextChild == visit.node->children.size()) {
+                if (m_stack.size() > 1)
+                    Leave();
+                m_stack.pop_back();
+                continue;
+            }
+            const Node& child = *visit.node->children[visit.nextChild];
+            const bool first = visit.nextChild++ == 0;
+            const uint64_t id = m_nextId++;
+            if (m_format == TreeFormat::Json && !first)
+                m_out.Put(',');
+            Enter(child, m_stack.size() - 1, id, visit.id);
+            m_stack.push_back({&child, 0, id}); // visit is invalid from here
+        }
+
+        switch (m_format) {
+        case TreeFormat::Text:
+            m_out.Put('\n');
+            break;
+        case TreeFormat::Dot:
+            m_out.Write("  }\n");
+            break;
+        case TreeFormat::Json:
+            m_out.Write("]}");
+            break;
+        }
+    }
+
+    void ParseTreeDumper::Enter(const Node& node, size_t depth, uint64_t id, uint64_t parentId) {
+        const std::string_view content = node.has_content() ? node.string_view() : "";
+        switch (m_format) {
+        case TreeFormat::Text:
+            for (size_t i = 0; i < depth; ++i)
+                m_out.Put(' ');
+            m_out.Write(node.type);
+            m_out.Write(": `");
+            m_out.Write(content);
+            m_out.Write("`\n");
+            break;
+        case TreeFormat::Dot:
+            m_out.Write("  n");
+            m_out.WriteUnsigned(id);
+            m_out.Write(" [label=\"");
+            WriteDotString(node.type);
+            m_out.Write("\\n");
+            WriteDotString(content);
+            m_out.Write("\"];\n  n");
+            m_out.WriteUnsigned(parentId);
+            m_out.Write(" -> n");
+            m_out.WriteUnsigned(id);
+            m_out.Write(";\n");
+            break;
+        case TreeFormat::Json:
+            m_out.Write("{\"type\": ");
+            m_out.WriteJsonString(node.type);
+            m_out.Write(", \"content\": ");
+            m_out.WriteJsonString(content);
+            m_out.Write(", \"children\": [");
+            break;
+        }
+    }
+
+    void ParseTreeDumper::Leave() {
+        if (m_format == TreeFormat::Json)
+            m_out.Write("]}");
+    }
+
+    // Quotes and backslashes escaped; tabs and other control characters as blanks
+    void ParseTreeDumper::WriteDotString(std::string_view text) {
+        size_t run = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char c = text[i];
+            if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20)
+                continue;
+            m_out.Write(text.substr(run, i - run));
+            run = i + 1;
+            if (c == '"' || c == '\\') {
+                m_out.Put('\\');
+                m_out.Put(c);
+            } else {
+                m_out.Put(' ');
+            }
+        }
+        m_out.Write(text.substr(run));
+    }
+
+} // namespace stabs
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "stabs_grammar.h"
+
+namespace stabs {
+
+    class BufferedWriter;
+
+    enum class TreeFormat : uint8_t {
+        Text, // One node per line, indented by depth: "stabs::instr_address: `072B`"
+        Dot,  // One graphviz digraph with a cluster per tree
+        Json, // An array with an object per tree
+    };
+
+    // Writes the parse trees of a listing's lines, e.g. to diff the trees of two grammar
+    // versions. Trees are walked with an explicit stack, and everything goes through the
+    // writer's buffer. Call Begin, then Dump for every tree, then End.
+    class ParseTreeDumper {
+    public:
+        // lineHeaders: Text only; without them each tree is just its nodes and a blank line
+        ParseTreeDumper(TreeFormat format, BufferedWriter& out, bool lineHeaders = true)
+            : m_format(format)
+            , m_out(out)
+            , m_lineHeaders(lineHeaders) {}
+
+        void Begin();
+        // root is the root node returned by parse_tree::parse for the line
+        void Dump(const Node& root, uint64_t lineNumber);
+        void End();
+
+    private:
+        struct Visit {
+            const Node* node;
+            size_t nextChild;
+            uint64_t id; // Dot
+        };
+
+        void Enter(const Node& node, size_t depth, uint64_t id, uint64_t parentId);
+        void Leave();
+        void WriteDotString(std::string_view text);
+
+        const TreeFormat m_format;
+        BufferedWriter& m_out;
+        const bool m_lineHeaders;
+        std::vector<Visit> m_stack;
+        uint64_t m_nextId = 0;
+        size_t m_trees = 0;
+    };
+
+} // namespace stabs
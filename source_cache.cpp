@@ -0,0 +1,87 @@
+#include "source_cache.h"
+
+#include <cstring>
+#include <utility>
+
+namespace stabs {
+
+    SourceCache::SourceCache(std::string rootDir, size_t maxFiles)
+        : m_rootDir(std::move(rootDir))
+        , m_maxFiles(maxFiles > 0 ? maxFiles : 1) {
+        if (!m_rootDir.empty() && m_rootDir.back() != '/' && m_rootDir.back() != '\\')
+            m_rootDir += '/';
+    }
+
+    std::optional<std::string_view> SourceCache::GetLine(std::string_view path, uint32_t line) {
+        Entry& entry = Get(path);
+        if (!entry.indexed)
+            BuildIndex(entry);
+
+        if (line == 0 || line >= entry.lineStarts.size())
+            return {};
+
+        const std::string_view data = entry.file.Data();
+        const uint32_t begin = entry.lineStarts[line - 1];
+        uint32_t end = entry.lineStarts[line];
+        // Strip the terminator
+        if (end > begin && data[end - 1] == '\n')
+            --end;
+        if (end > begin && data[end - 1] == '\r')
+            --end;
+        return data.substr(begin, end - begin);
+    }
+
+    uint32_t SourceCache::LineCount(std::string_view path) {
+        Entry& entry = Get(path);
+        if (!entry.indexed)
+            BuildIndex(entry);
+        return entry.lineStarts.empty() ? 0 : static_cast<uint32_t>(entry.lineStarts.size() - 1);
+    }
+
+    void SourceCache::Clear() {
+        m_entries.clear();
+        m_lru.clear();
+    }
+
+    SourceCache::Entry& SourceCache::Get(std::string_view path) {
+        if (auto it = m_entries.find(path); it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            return m_lru.front();
+        }
+
+        if (m_lru.size() >= m_maxFiles) {
+            m_entries.erase(m_lru.back().path);
+            m_lru.pop_back();
+        }
+
+        m_lru.emplace_front();
+        Entry& entry = m_lru.front();
+        entry.path = std::string(path);
+        entry.file.Open(m_rootDir + entry.path);
+        // Keyed by the entry's own copy of the path, which lives as long as the entry
+        m_entries.emplace(entry.path, m_lru.begin());
+        return entry;
+    }
+
+    void SourceCache::BuildIndex(Entry& entry) {
+        entry.indexed = true;
+        if (!entry.file.IsOpen())
+            return;
+
+        // lineStarts[i] is the offset of line i + 1; the last element is the end of the file
+        const std::string_view data = entry.file.Data();
+        entry.lineStarts.push_back(0);
+        const char* p = data.data();
+        const char* end = p + data.size();
+        while (p < end) {
+            auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!eol)
+                break;
+            p = eol + 1;
+            entry.lineStarts.push_back(static_cast<uint32_t>(p - data.data()));
+        }
+        if (entry.lineStarts.back() != data.size())
+            entry.lineStarts.push_back(static_cast<uint32_t>(data.size()));
+    }
+
+} // namespace stabs
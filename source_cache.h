@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace stabs {
+
+    // Maps the source files referenced by include_file (N_SOL) paths on first use, and indexes
+    // their line offsets the first time a line is requested. At most maxFiles stay mapped; the
+    // least recently used one is unmapped when another file is needed. Files that fail to open
+    // are remembered too, so a missing file isn't retried on every break.
+    class SourceCache {
+    public:
+        explicit SourceCache(std::string rootDir = {}, size_t maxFiles = 16);
+
+        // Returns the text of a 1-based line without its line terminator
+        std::optional<std::string_view> GetLine(std::string_view path, uint32_t line);
+
+        // Number of lines in the file, or 0 if it couldn't be read
+        uint32_t LineCount(std::string_view path);
+
+        void Clear();
+
+    private:
+        struct Entry {
+            std::string path;
+            MappedFile file;
+            std::vector<uint32_t> lineStarts; // Built on first line request
+            bool indexed = false;
+        };
+
+        Entry& Get(std::string_view path);
+        static void BuildIndex(Entry& entry);
+
+        std::string m_rootDir;
+        size_t m_maxFiles;
+        std::list<Entry> m_lru; // Most recently used first
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> m_entries;
+    };
+
+} // namespace stabs
@@ -0,0 +1,448 @@
+#pragma once
+
+#include <tao/pegtl.hpp>
+#include <tao/pegtl/contrib/parse_tree.hpp>
+
+namespace pegtl = TAO_PEGTL_NAMESPACE;
+
+#include "char_class.h"
+#include "stabs_grammar_order.h"
+
+namespace stabs {
+    // Any number of characters of SET (a CharSet), skipped with SET::Span. SET must not contain
+    // line terminators, as the line count isn't updated.
+    template <typename SET>
+    struct star_set {
+        using rule_t = star_set;
+        using subs_t = pegtl::empty_list;
+
+        template <typename ParseInput>
+        static bool match(ParseInput& in) {
+            in.bump_in_this_line(SET::Span(in.current(), in.end()));
+            return true;
+        }
+    };
+
+    // One character of FIRST followed by any number of OTHER
+    template <typename FIRST, typename OTHER = FIRST>
+    struct plus_set {
+        using rule_t = plus_set;
+        using subs_t = pegtl::empty_list;
+
+        template <typename ParseInput>
+        static bool match(ParseInput& in) {
+            if (in.empty() || !FIRST::Contains(in.peek_char()))
+                return false;
+            in.bump_in_this_line(1 + OTHER::Span(in.current() + 1, in.end()));
+            return true;
+        }
+    };
+} // namespace stabs
+
+namespace TAO_PEGTL_NAMESPACE {
+    template <typename Name, typename SET>
+    struct analyze_traits<Name, stabs::star_set<SET>> : analyze_opt_traits<> {};
+
+    template <typename Name, typename FIRST, typename OTHER>
+    struct analyze_traits<Name, stabs::plus_set<FIRST, OTHER>> : analyze_any_traits<> {};
+} // namespace TAO_PEGTL_NAMESPACE
+
+namespace stabs {
+    using namespace pegtl;
+
+    // An alternative of a reorderable choice. Each alternative must be followed by ANCHOR, so
+    // none can succeed on a prefix of another one's match ("bool:t22" of an enum), and the order
+    // of the alternatives only affects speed.
+    template <typename RULE, typename ANCHOR>
+    struct alternative : seq<RULE, at<ANCHOR>> {};
+
+    // sor over a type_list of alternatives; the lists are in stabs_grammar_order.h
+    template <typename ANCHOR, typename LIST>
+    struct ordered_sor;
+    template <typename ANCHOR, typename... RULES>
+    struct ordered_sor<ANCHOR, type_list<RULES...>> : sor<alternative<RULES, ANCHOR>...> {};
+
+    // Similar to until<R> except that it does not consume R
+    template <typename RULE>
+    struct until_not_at : star<not_at<RULE>, any> {};
+
+    using BlankSet = CharSet<' ', ' ', '\t', '\t'>;
+    using AlnumSet = CharSet<'a', 'z', 'A', 'Z', '0', '9'>;
+    using FilePathSet =
+        CharSet<'a', 'z', 'A', 'Z', '0', '9', '-', '-', '_', '_', '/', '/', '.', '.'>;
+
+    // Character classes are table driven (see CharSet), and hide pegtl::identifier
+    struct identifier : plus_set<IdentifierFirstSet, IdentifierOtherSet> {};
+    struct blanks : star_set<BlankSet> {};
+    struct digits : seq<opt<one<'-'>>, plus_set<DigitSet>> {};
+    struct dquote : one<'\"'> {};
+    struct comma : one<','> {};
+    struct unquoted_string : plus_set<AlnumSet> {};
+    struct dquoted_string : seq<dquote, until<dquote>> {};
+    struct sep : seq<blanks, comma, blanks> {};
+    struct file_path : star_set<FilePathSet> {};
+
+    // Match stabs type string for N_LSYM: type definitions, struct/union/enum tags, or local
+    // variable declarations
+    //   "int:t7=r7;-32768;32767;"
+    //   "Foo:T26=s4a:7,0,8;b:27=*7,8,16;;"
+    //   "a:7"
+    //
+    // Every type is referred to by number, and a reference may define the number on the spot
+    // ("25=*7"). Definitions nest, and may refer to numbers the unit only defines later; the
+    // loader links the numbers once the whole unit has been read.
+    //
+    // https://sourceware.org/gdb/current/onlinedocs/stabs/Type-Descriptors.html
+
+    struct type_number : digits {};
+    struct type_desc;
+    struct type_ref : seq<type_number, opt<one<'='>, type_desc>> {};
+
+    // Another name for a type
+    // myint:t26=7
+    struct alias_type : seq<type_ref> {};
+
+    // 25=*7
+    struct pointer_type : seq<one<'*'>, type_ref> {};
+
+    // const int: 26=k7, volatile int: 26=B7
+    struct const_type : seq<one<'k'>, type_ref> {};
+    struct volatile_type : seq<one<'B'>, type_ref> {};
+
+    // Function returning int
+    // 26=f7
+    struct function_type : seq<one<'f'>, type_ref> {};
+
+    // Range of the type itself, or of another type. If lower > upper, lower is the size in
+    // bytes (floating point types).
+    // char:t13=r13;0;255;
+    struct range_lower_bound : digits {};
+    struct range_upper_bound : digits {};
+    struct range_type : seq<one<'r', 'R'>, type_ref, one<';'>, range_lower_bound, one<';'>,
+                            range_upper_bound, one<';'>> {};
+
+    // Index type, index bounds, then the element type, which is the next dimension if any
+    // int c[10][11];   c:25=ar26=r26;0;-1;;0;9;27=ar26;0;10;7
+    // int* pi[4];      pi:29=ar26;0;3;30=*7
+    struct array_lower_bound : digits {};
+    struct array_upper_bound : digits {};
+    struct array_type : seq<string<'a', 'r'>, type_ref, one<';'>, array_lower_bound, one<';'>,
+                            array_upper_bound, one<';'>, type_ref> {};
+
+    // bool:t22=eFalse:0,True:1,;
+    // WeekDay:t25=eMonday:0,Tuesday:1,Wednesday:2,EndOfDays:2,Foo:-5000,;
+    struct enum_value_id : identifier {};
+    struct enum_value_num : digits {};
+    struct enum_value : seq<enum_value_id, one<':'>, enum_value_num, comma> {};
+    struct enum_type : seq<one<'e'>, plus<enum_value>, one<';'>> {};
+
+    // Struct or union: byte size, C++ base classes, members (name, type, bit offset and bit
+    // size), C++ member functions, and for classes with virtual functions the type holding the
+    // vtable pointer.
+    // Foo:T26=s4a:7,0,8;b:7,8,8;c:7,16,8;d:7,24,6;e:7,30,2;;
+    // Bar:Tt27=s6!1,020,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;
+
+    // Base class: virtual flag, access ('0' private, '1' protected, '2' public) and bit offset
+    // as one number, then the type
+    // !1,020,26;
+    struct base_spec : seq<one<'0', '1'>, one<'0', '1', '2'>, plus_set<DigitSet>> {};
+    struct base_class : seq<base_spec, comma, type_ref, one<';'>> {};
+    struct base_classes : seq<one<'!'>, digits, comma, plus<base_class>> {};
+
+    // C++ members may have a visibility ("/2"), and compiler generated names ("$vf26")
+    struct struct_member_name : plus<not_one<':', ';', ',', '\"'>> {};
+    struct struct_member_bit_offset : digits {};
+    struct struct_member_bit_size : digits {};
+    struct struct_member_visibility : seq<one<'/'>, one<'0', '1', '2', '9'>> {};
+    struct struct_member
+        : seq<struct_member_name, one<':'>, opt<struct_member_visibility>, type_ref, comma,
+              struct_member_bit_offset, comma, struct_member_bit_size, one<';'>> {};
+
+    // Method type: the return type, or the class, return type and argument types
+    // 28=##7;   28=#27,7,27,13;
+    struct method_return : seq<type_ref> {};
+    struct method_type
+        : seq<one<'#'>,
+              sor<seq<one<'#'>, method_return>, seq<type_ref, comma, method_return,
+                                                     star<comma, type_ref>>>,
+              one<';'>> {};
+
+    // Member function: the name, then each overload's type, mangled name, access, qualifiers
+    // ('A' to 'D'), and '.', '?' (static) or '*' with the vtable index and class (virtual)
+    // get::28=##7;:_ZN3Bar3getEv;2A.;
+    // f::29=##7;:_ZN3Bar1fEv;2A*0;27;;
+    struct method_name : plus<not_one<':', ';', ',', '\"'>> {};
+    struct method_phys_name : plus<not_one<';', '\"'>> {};
+    struct method_access : one<'0', '1', '2'> {};
+    struct method_virtual : seq<one<'*'>, digits, one<';'>, type_ref, one<';'>> {};
+    struct method_static : one<'?'> {};
+    struct method_variant
+        : seq<type_ref, one<':'>, method_phys_name, one<';'>, method_access,
+              one<'A', 'B', 'C', 'D'>, sor<method_virtual, method_static, one<'.'>>> {};
+    struct method : seq<method_name, string<':', ':'>, plus<method_variant>, one<';'>> {};
+
+    // ~%27;
+    struct vtable_holder : seq<one<'~'>, one<'%'>, type_ref, one<';'>> {};
+
+    struct struct_byte_size : digits {};
+    template <char KIND>
+    struct aggregate_for
+        : seq<one<KIND>, struct_byte_size, opt<base_classes>, star<struct_member>, star<method>,
+              one<';'>, opt<vtable_holder>> {};
+    struct struct_type : aggregate_for<'s'> {};
+    struct union_type : aggregate_for<'u'> {};
+
+    // Struct, union or enum referred to by name, typically one that is only declared in the
+    // unit (or defined after its use)
+    // 26=xsFoo:
+    struct xref_kind : one<'s', 'u', 'e'> {};
+    struct xref_name : plus<not_one<':', '\"'>> {};
+    struct xref_type : seq<one<'x'>, xref_kind, xref_name, one<':'>> {};
+
+    struct type_desc
+        : sor<pointer_type, const_type, volatile_type, function_type, method_type, range_type,
+              array_type, enum_type, struct_type, union_type, xref_type, alias_type> {};
+
+    // Type names may have blanks ("unsigned int") or template arguments ("Foo<int>")
+    struct type_name : plus<not_one<':', '\"'>> {};
+    struct type_def : seq<type_name, one<':'>, one<'t'>, type_ref> {};
+
+    // In C++, a tag is also a type name ("Tt")
+    struct tag_type_def : one<'t'> {};
+    struct tag_def : seq<type_name, one<':'>, one<'T'>, opt<tag_type_def>, type_ref> {};
+
+    // a:7
+    // p:25=*7
+    struct variable_name : identifier {};
+    struct variable : seq<variable_name, one<':'>, type_ref> {};
+
+    struct lsym : ordered_sor<dquote, lsym_order> {};
+
+    struct include_file : file_path {};
+
+    using DEFAULT_PARAM_STRING_RULE = until_not_at<dquote>;
+    template <typename RULE = DEFAULT_PARAM_STRING_RULE>
+    struct param_string : seq<dquote, RULE, dquote> {};
+
+    using DEFAULT_PARAM_TYPE_RULE = until_not_at<comma>;
+    template <typename RULE = DEFAULT_PARAM_TYPE_RULE>
+    struct param_type : seq<RULE> {};
+
+    using DEFAULT_PARAM_OTHER_RULE = until_not_at<comma>;
+    template <typename RULE = DEFAULT_PARAM_OTHER_RULE>
+    struct param_other : digits {};
+
+    using DEFAULT_PARAM_DESC_RULE = until_not_at<comma>;
+    template <typename RULE = DEFAULT_PARAM_DESC_RULE>
+    struct param_desc : seq<RULE> {};
+
+    using DEFAULT_PARAM_VALUE_RULE = until_not_at<eol>;
+    template <typename RULE = DEFAULT_PARAM_VALUE_RULE>
+    struct param_value : seq<RULE> {};
+
+    struct str_stabs : TAO_PEGTL_STRING(".stabs") {};
+    struct str_stabd : TAO_PEGTL_STRING(".stabd") {};
+    struct str_stabn : TAO_PEGTL_STRING(".stabn") {};
+
+    struct stabs_directive_prefix : seq<until<str_stabs>, blanks> {};
+    struct stabd_directive_prefix : seq<until<str_stabd>, blanks> {};
+    struct stabn_directive_prefix : seq<until<str_stabn>, blanks> {};
+
+    // Match stabs (string) directive
+    // Captures: 1:string, 2:type, 3:other, 4:desc, 5:value
+    //    204 ;	.stabs	"src/vectrexy.h",132,0,0,Ltext2
+    template <typename STRING_RULE, typename TYPE_RULE, typename OTHER_RULE, typename DESC_RULE,
+              typename VALUE_RULE>
+    struct stabs_directive_for
+        : seq<stabs_directive_prefix, param_string<STRING_RULE>, sep, param_type<TYPE_RULE>, sep,
+              param_other<OTHER_RULE>, sep, param_desc<DESC_RULE>, sep, param_value<VALUE_RULE>> {};
+
+    // Match stabd (dot) directive
+    // Captures: 1:type, 2:other, 3:desc
+    //    206;.stabd	68, 0, 61
+    template <typename TYPE_RULE, typename OTHER_RULE, typename DESC_RULE>
+    struct stabd_directive_for : seq<stabd_directive_prefix, param_type<TYPE_RULE>, sep,
+                                     param_other<OTHER_RULE>, sep, param_desc<DESC_RULE>> {};
+
+    // Match stabn (number) directive
+    // Captures: 1:type, 2:other, 3:desc, 4:value
+    //    869;.stabn	192, 0, 0, LBB8
+    template <typename TYPE_RULE, typename OTHER_RULE, typename DESC_RULE, typename VALUE_RULE>
+    struct stabn_directive_for
+        : seq<stabn_directive_prefix, param_type<TYPE_RULE>, sep, param_other<OTHER_RULE>, sep,
+              param_desc<DESC_RULE>, sep, param_value<VALUE_RULE>> {};
+
+    // N_LSYM = 128;  // 0x80 Local variable or type definition
+    // 95 ;	.stabs	"a:7",128,0,0,0
+    // For local variables, the value is the offset in the stack frame
+    struct lsym_value : DEFAULT_PARAM_VALUE_RULE {};
+    struct stabs_directive_lsym
+        : stabs_directive_for<lsym, TAO_PEGTL_STRING("128"), DEFAULT_PARAM_OTHER_RULE,
+                              DEFAULT_PARAM_DESC_RULE, lsym_value> {};
+
+    // N_SOL = 132;   // 0x84 Name of include file
+    // 80 ;	.stabs	"src/main.cpp",132,0,0,Ltext2
+    struct stabs_directive_include_file
+        : stabs_directive_for<include_file, TAO_PEGTL_STRING("132"), DEFAULT_PARAM_OTHER_RULE,
+                              DEFAULT_PARAM_DESC_RULE, DEFAULT_PARAM_VALUE_RULE> {};
+
+    // https://sourceware.org/gdb/current/onlinedocs/stabs/Statics.html#Statics
+    // 107 ;	.stabs	"var_const:S7",36,0,0,__ZL9var_const
+    // 108;     .stabs	"var_init:S7", 38, 0, 0, __ZL8var_init
+    // 109;     .stabs	"var_noinit:S7", 40, 0, 0, __ZL10var_noinit
+    // 94 ;	    .stabs	"main:F7",36,0,0,_main
+    // 101 ;	.stabs	"c_a:S7",36,0,0,__ZL3c_a
+    // 105;     .stabs	"var_s_local:V7", 38, 0, 0, __ZZ4mainE11var_s_local
+    //
+    // S means file static, V means function static, F means function, G means global
+    // These constant names aren't very meaningful or good.
+    // N_GSYM = 32;   // 0x20 Global variable (value is unused, address comes from the label)
+    // N_FUN = 36;    // 0x24 Text section (compile-time initialized - functions, constants)
+    // N_STSYM = 38;  // 0x26 Data section (runtime initialized - i.e. ctor calls)
+    // N_LCSYM = 40;  // 0x28 BSS section (uninitialized)
+
+    struct symbol_name : identifier {};
+    struct symbol_id : digits {};
+    struct symbol_type_function : one<'F'> {};
+    struct symbol_type_file_static : one<'S'> {};
+    struct symbol_type_function_static : one<'V'> {};
+    struct symbol_type_global : one<'G'> {};
+    struct section_symbol
+        : seq<symbol_name, one<':'>,
+              sor<symbol_type_function, symbol_type_file_static, symbol_type_function_static,
+                  symbol_type_global>,
+              symbol_id> {};
+
+    struct section_symbol_label : DEFAULT_PARAM_VALUE_RULE {};
+
+    // The stab type gives the section the symbol is in
+    struct section_global : TAO_PEGTL_STRING("32") {};
+    struct section_text : TAO_PEGTL_STRING("36") {};
+    struct section_data : TAO_PEGTL_STRING("38") {};
+    struct section_bss : TAO_PEGTL_STRING("40") {};
+
+    struct stabs_directive_section_symbol
+        : stabs_directive_for<section_symbol,
+                              sor<section_global, section_text, section_data, section_bss>,
+                              DEFAULT_PARAM_OTHER_RULE, DEFAULT_PARAM_DESC_RULE,
+                              section_symbol_label> {};
+
+    struct stabs_directive : ordered_sor<eof, stabs_directive_order> {};
+
+    // N_SLINE = 68;  // 0x44 Line number in text segment
+    // 70 ;	.stabd	68,0,3
+    struct source_current_line : digits {};
+    struct stabd_directive_line
+        : stabd_directive_for<TAO_PEGTL_STRING("68"), DEFAULT_PARAM_OTHER_RULE,
+                              source_current_line> {};
+
+    struct stabd_directive : sor<stabd_directive_line> {};
+
+    // N_LBRAC = 192; // 0xC0 Left brace (open scope)
+    // N_RBRAC = 224; // 0xE0 Right brace (close scope)
+    struct left_brace : TAO_PEGTL_STRING("192") {};
+    struct right_brace : TAO_PEGTL_STRING("224") {};
+
+    // Label at the start/end of the block, possibly relative to the function ("LBB2-_main")
+    struct brace_label : DEFAULT_PARAM_VALUE_RULE {};
+
+    struct stabn_directive_brace
+        : stabn_directive_for<sor<left_brace, right_brace>, DEFAULT_PARAM_OTHER_RULE,
+                              DEFAULT_PARAM_DESC_RULE, brace_label> {};
+
+    struct stabn_directive : sor<stabn_directive_brace> {};
+
+    // Match an instruction line
+    // Capture: 1:address
+    //   072B AE E4         [ 5]  126 	ldx	,s	; tmp33, dest
+    struct instr_address : seq<xdigit, xdigit, xdigit, xdigit> {};
+    struct instruction
+        : seq<blanks, instr_address, until<one<'['>>, any, any, one<']'>, star<any>> {};
+
+    // Match a label line
+    // Captures: 1:address, 2:label
+    //   086C                     354 Lscope3:
+    struct label_address : seq<xdigit, xdigit, xdigit, xdigit> {};
+    struct label_name : identifier {};
+    struct label : seq<blanks, label_address, blanks, plus<digits>, blanks, label_name, one<':'>> {
+    };
+
+    // Match a label line of compiler output
+    // Capture: 1:label
+    // _main:
+    struct asm_label : seq<label_name, one<':'>, blanks> {};
+
+    template <typename... ALTERNATIVES>
+    struct listing_line_for : seq<sor<ALTERNATIVES...>, eof> {};
+
+    // Matches any line of interest; lines that don't match are simply skipped by the loader
+    struct listing_line : ordered_sor<eof, listing_line_order> {};
+
+    // Capture profiles: listing_line variants for tools that only need some of the tables.
+    // Directives a profile doesn't list are never tried in full; their lines fail on the first
+    // mismatching character of the string (e.g. the 't' in "int:t7") and are skipped, so no
+    // lsym grammar runs and nothing is captured for them.
+
+    // Line table: N_SOL, N_SLINE and instruction addresses
+    struct stabs_directive_line_table : sor<stabs_directive_include_file> {};
+    struct listing_line_line_table
+        : listing_line_for<instruction, stabs_directive_line_table, stabd_directive> {};
+
+    // Symbols: section symbols, the labels that give their addresses and the instructions that
+    // give function sizes
+    struct stabs_directive_symbols : sor<stabs_directive_section_symbol> {};
+    struct listing_line_symbols : listing_line_for<instruction, label, stabs_directive_symbols> {};
+
+    // Compiler output (.s): the directives are the same as in listings, but labels have no
+    // addresses and instructions are of no use
+    struct assembly_line
+        : listing_line_for<stabs_directive, stabd_directive, stabn_directive, asm_label> {};
+
+    struct grammar : must<listing_line> {};
+
+    // Types selected in for parse tree
+    template <typename Rule>
+    using selector = parse_tree::selector<
+        Rule, pegtl::parse_tree::store_content::on<
+                  // top-level
+                  stabd_directive, stabs_directive, stabn_directive,
+                  // capture profiles
+                  stabs_directive_line_table, stabs_directive_symbols,
+
+                  // lsym
+                  type_def, tag_def, tag_type_def, type_name, variable, variable_name,
+                  // type references and definitions
+                  type_ref, type_number, alias_type, pointer_type, const_type, volatile_type,
+                  function_type, range_type, range_lower_bound, range_upper_bound, array_type,
+                  array_lower_bound, array_upper_bound, xref_type, xref_kind, xref_name,
+                  // enum
+                  enum_type, enum_value_id, enum_value_num,
+                  // struct and union
+                  struct_type, union_type, struct_byte_size, base_class, base_spec,
+                  struct_member, struct_member_name, struct_member_bit_offset,
+                  struct_member_bit_size, method, method_name, method_variant, method_type,
+                  method_return, method_phys_name, method_access, method_virtual, method_static,
+                  vtable_holder,
+                  // instruction
+                  instruction, instr_address,
+                  // label
+                  label, label_address, label_name, asm_label,
+                  // include_file
+                  include_file,
+                  // line number
+                  source_current_line,
+                  // symbols
+                  stabs_directive_section_symbol, /*section_symbol,*/ symbol_name, symbol_id,
+                  symbol_type_function, symbol_type_file_static, symbol_type_function_static,
+                  symbol_type_global, section_global, section_text, section_data, section_bss,
+                  section_symbol_label,
+                  // local variable frame offset
+                  lsym_value,
+                  // braces
+                  left_brace, right_brace, brace_label
+
+                  >>;
+
+    using Node = pegtl::parse_tree::node;
+
+} // namespace stabs
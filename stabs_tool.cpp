@@ -0,0 +1,632 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <tao/pegtl/demangle.hpp>
+
+#include "address_index.h"
+#include "buffered_writer.h"
+#include "debug_info.h"
+#include "debug_info_diff.h"
+#include "direct_page.h"
+#include "footprint.h"
+#include "json_export.h"
+#include "lazy_loader.h"
+#include "linker_map.h"
+#include "listing_loader.h"
+#include "listing_text.h"
+#include "mapped_file.h"
+#include "name_resolver.h"
+#include "parse_tree_dump.h"
+#include "source_cache.h"
+#include "stabs_grammar.h"
+#include "stack_depth.h"
+#include "struct_layout.h"
+
+namespace {
+    using Args = std::vector<std::string>;
+
+    bool EndsWith(std::string_view s, std::string_view suffix) {
+        return s.size() >= suffix.size() && s.substr(s.size() - suffix.size()) == suffix;
+    }
+
+    // The whole token as a number no greater than max
+    bool ParseNumber(std::string_view token, int base, uint32_t max, uint32_t& value) {
+        const char* end = token.data() + token.size();
+        auto [last, error] = std::from_chars(token.data(), end, value, base);
+        return !token.empty() && error == std::errc() && last == end && value <= max;
+    }
+
+    // "<path>@<bank>" or "<path>". An '@' followed by a directory or file name belongs to the
+    // path ("build@2/main.lst", "main@2.lst"); anything else after it must be a bank number.
+    bool ParseListingArg(const std::string& arg, std::string& path, stabs::BankId& bank) {
+        path = arg;
+        bank = 0;
+        const size_t at = arg.rfind('@');
+        if (at == std::string::npos || arg.find_first_of("/\\.", at) != std::string::npos)
+            return true;
+        uint32_t number = 0;
+        if (!ParseNumber(std::string_view(arg).substr(at + 1), 10, stabs::MaxBanks - 1, number)) {
+            std::cerr << "Bad bank in " << arg << ": expected <path>@<0-"
+                      << stabs::MaxBanks - 1 << ">\n";
+            return false;
+        }
+        path = arg.substr(0, at);
+        bank = static_cast<stabs::BankId>(number);
+        return true;
+    }
+
+    // Listings of banked cartridges are given as <path>@<bank>. Compiler output (.s) can be
+    // given instead of listings, after the linker map of its link: <map>.map <file>.s...
+    bool LoadListings(const Args& paths, stabs::DebugInfo& info,
+                      stabs::CaptureProfile profile = stabs::CaptureProfile::Full) {
+        stabs::LinkerMap linkerMap;
+        for (auto& arg : paths) {
+            std::string path;
+            stabs::LoadOptions options;
+            options.profile = profile;
+            if (!ParseListingArg(arg, path, options.bank))
+                return false;
+
+            if (EndsWith(path, ".map")) {
+                linkerMap.Clear();
+                if (!linkerMap.Load(path)) {
+                    std::cerr << "Failed to read " << path << "\n";
+                    return false;
+                }
+                continue;
+            }
+            if (EndsWith(path, ".s")) {
+                options.format = stabs::InputFormat::Assembly;
+                options.linkerMap = &linkerMap;
+            }
+
+            if (!stabs::LoadListingFile(path, info, options)) {
+                std::cerr << "Failed to read " << path << "\n";
+                return false;
+            }
+        }
+        // Calls between units resolve once they are all loaded
+        stabs::ComputeStackDepths(info);
+        return true;
+    }
+
+    // Address as hex, optionally prefixed with a bank: "C880" or "2:C880"
+    bool ParseBankedAddress(const std::string& arg, stabs::BankId& bank, uint32_t& address) {
+        const size_t colon = arg.find(':');
+        uint32_t bankNumber = 0;
+        if ((colon != std::string::npos &&
+             !ParseNumber(std::string_view(arg).substr(0, colon), 10, 0xFF, bankNumber)) ||
+            !ParseNumber(std::string_view(arg).substr(colon == std::string::npos ? 0 : colon + 1),
+                         16, 0xFFFF, address)) {
+            std::cerr << "Bad address " << arg << ": expected [bank:]hex, e.g. 2:C880\n";
+            return false;
+        }
+        bank = static_cast<stabs::BankId>(bankNumber);
+        return true;
+    }
+
+    // types <listing>...: prints every type in the loaded listings
+    int Types(const Args& args) {
+        stabs::DebugInfo info;
+        if (!LoadListings(args, info))
+            return 1;
+
+        for (auto& unit : info.units) {
+            std::cout << info.strings.Get(unit.name) << "\n";
+            for (auto id = unit.firstType; id < unit.firstType + unit.numTypes; ++id) {
+                std::cout << "  " << info.types[id].stabsId << ": " << info.TypeName(id) << " ("
+                          << info.types[id].byteSize << " bytes)\n";
+            }
+        }
+        return 0;
+    }
+
+    // diff <before-listing>... -- <after-listing>...: reports changed layouts, values and addresses
+    int Diff(const Args& args) {
+        const auto separator = std::find(args.begin(), args.end(), "--");
+        if (separator == args.end()) {
+            std::cerr << "Expected -- between the two builds\n";
+            return 1;
+        }
+
+        stabs::DebugInfo before, after;
+        if (!LoadListings(Args(args.begin(), separator), before) ||
+            !LoadListings(Args(separator + 1, args.end()), after))
+            return 1;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto entries = stabs::Diff(before, after);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        for (auto& entry : entries) {
+            std::cout << stabs::ToString(entry.change) << " " << stabs::ToString(entry.entity)
+                      << " " << entry.name;
+            if (!entry.details.empty())
+                std::cout << ": " << entry.details;
+            std::cout << "\n";
+        }
+        std::cerr << entries.size() << " differences in "
+                  << std::chrono::duration<double, std::milli>(elapsed).count() << " ms\n";
+        return 0;
+    }
+
+    // lines <source-root> <listing>...: prints the line table with the source text of each line
+    int Lines(const Args& args) {
+        if (args.empty())
+            return 1;
+        stabs::DebugInfo info;
+        if (!LoadListings(Args(args.begin() + 1, args.end()), info,
+                          stabs::CaptureProfile::LineTable))
+            return 1;
+
+        stabs::SourceCache sources(args[0]);
+        for (auto& entry : info.lines) {
+            const std::string_view file = info.strings.Get(entry.file);
+            std::printf("%04X %.*s:%u", entry.address, static_cast<int>(file.size()), file.data(),
+                        entry.line);
+            if (auto text = sources.GetLine(file, entry.line))
+                std::printf("\t%.*s", static_cast<int>(text->size()), text->data());
+            std::printf("\n");
+        }
+        return 0;
+    }
+
+    // resolve <[bank:]pc> <name> <listing>...: resolves an identifier in the scope of a (hex) PC
+    int Resolve(const Args& args) {
+        if (args.size() < 3)
+            return 1;
+        stabs::DebugInfo info;
+        if (!LoadListings(Args(args.begin() + 2, args.end()), info))
+            return 1;
+
+        stabs::NameResolver resolver(info);
+        stabs::BankId bank;
+        uint32_t pc;
+        if (!ParseBankedAddress(args[0], bank, pc))
+            return 1;
+        const auto binding = resolver.Resolve(bank, pc, args[1]);
+        switch (binding.kind) {
+        case stabs::BindingKind::None:
+            std::cout << args[1] << ": not found\n";
+            return 1;
+        case stabs::BindingKind::Local: {
+            auto& var = info.variables[binding.index];
+            std::cout << args[1] << ": local " << info.TypeName(var.type) << " at frame offset "
+                      << var.frameOffset << "\n";
+            break;
+        }
+        case stabs::BindingKind::Static: {
+            auto& symbol = info.symbols[binding.index];
+            std::printf("%s: static %.*s at %04X\n", args[1].c_str(),
+                        static_cast<int>(info.TypeName(symbol.type).size()),
+                        info.TypeName(symbol.type).data(), symbol.address);
+            break;
+        }
+        }
+        return 0;
+    }
+
+    // directpage <listing>...: variables worth moving into the direct page, ranked by the
+    // extended-addressing instructions that refer to them per byte
+    int DirectPage(const Args& args) {
+        stabs::DebugInfo info;
+        if (!LoadListings(args, info))
+            return 1;
+
+        for (auto& candidate : stabs::AdviseDirectPage(info, {})) {
+            const stabs::Symbol& symbol = info.symbols[candidate.symbol];
+            const std::string_view name = info.strings.Get(symbol.name);
+            std::printf("%c %04X %-24.*s %3u bytes %5u instructions\n",
+                        candidate.fits ? '*' : ' ', symbol.address,
+                        static_cast<int>(name.size()), name.data(), candidate.size,
+                        candidate.extendedInstructions);
+        }
+        return 0;
+    }
+
+    // footprint [--json] <listing>...: RAM and ROM use by unit, file and type
+    int Footprint(const Args& args) {
+        const bool json = !args.empty() && args[0] == "--json";
+        stabs::DebugInfo info;
+        if (!LoadListings(Args(args.begin() + (json ? 1 : 0), args.end()), info))
+            return 1;
+
+        const stabs::Footprint footprint = stabs::ComputeFootprint(info);
+        stabs::BufferedWriter out(stdout);
+        if (json)
+            stabs::WriteFootprintJson(footprint, out);
+        else
+            stabs::WriteFootprintText(footprint, out);
+        out.Flush();
+        return out.Failed() ? 1 : 0;
+    }
+
+    // export <listing>...: the types, symbols, line table and scopes as JSON
+    int Export(const Args& args) {
+        stabs::DebugInfo info;
+        if (!LoadListings(args, info))
+            return 1;
+
+        stabs::BufferedWriter out(stdout);
+        stabs::WriteDebugInfoJson(info, out);
+        out.Flush();
+        return out.Failed() ? 1 : 0;
+    }
+
+    // layout <listing>...: structs that would shrink with their members reordered, with the
+    // suggested order
+    int Layout(const Args& args) {
+        stabs::DebugInfo info;
+        if (!LoadListings(args, info))
+            return 1;
+
+        for (auto& suggestion : stabs::AdviseStructLayouts(info)) {
+            const std::string_view name = info.TypeName(suggestion.type);
+            std::printf("%.*s: %u -> %u bytes, %u hole bits, %llu instances:",
+                        static_cast<int>(name.size()), name.data(), suggestion.byteSize,
+                        suggestion.compactSize, suggestion.holeBits,
+                        static_cast<unsigned long long>(suggestion.instances));
+            for (uint32_t m : suggestion.order) {
+                const std::string_view member = info.strings.Get(info.members[m].name);
+                std::printf(" %.*s", static_cast<int>(member.size()), member.data());
+            }
+            std::printf("\n");
+        }
+        return 0;
+    }
+
+    // stack <listing>...: worst-case stack use of each entry point, deepest first, with its path
+    int Stack(const Args& args) {
+        stabs::DebugInfo info;
+        if (!LoadListings(args, info))
+            return 1;
+
+        auto entries = stabs::StackEntryPoints(info);
+        std::sort(entries.begin(), entries.end(), [&](uint32_t a, uint32_t b) {
+            return info.functions[a].maxStack > info.functions[b].maxStack;
+        });
+        auto functionName = [&](uint32_t f) {
+            return info.strings.Get(info.symbols[info.functions[f].symbol].name);
+        };
+        for (uint32_t entry : entries) {
+            const stabs::Function& function = info.functions[entry];
+            const std::string_view name = functionName(entry);
+            std::printf("%5u %.*s%s%s:", function.maxStack, static_cast<int>(name.size()),
+                        name.data(), function.recursive ? " (recursive)" : "",
+                        function.incomplete ? " (unknown calls)" : "");
+            for (uint32_t f : stabs::DeepestPath(info, entry)) {
+                const std::string_view step = functionName(f);
+                std::printf(" %.*s", static_cast<int>(step.size()), step.data());
+            }
+            std::printf("\n");
+        }
+        return 0;
+    }
+
+    // where <[bank:]pc> <listing>...: pre-scans the listings, then loads only the unit of a (hex)
+    // PC to print its function and line while the others load in the background
+    int Where(const Args& args) {
+        if (args.size() < 2)
+            return 1;
+        stabs::BankId bank;
+        uint32_t pc;
+        if (!ParseBankedAddress(args[0], bank, pc))
+            return 1;
+
+        stabs::LazyLoader loader;
+        for (auto arg = args.begin() + 1; arg != args.end(); ++arg) {
+            stabs::LoadOptions options;
+            std::string path;
+            if (!ParseListingArg(*arg, path, options.bank))
+                return 1;
+            if (!loader.AddListing(path, options)) {
+                std::cerr << "Failed to read " << path << "\n";
+                return 1;
+            }
+        }
+        loader.Prioritize(bank, pc);
+        loader.Start();
+
+        const uint32_t unit = loader.FindUnit(bank, pc);
+        stabs::DebugInfo* info = loader.TouchUnit(unit);
+        if (!info) {
+            std::printf("%04X: no unit\n", pc);
+            return 1;
+        }
+        stabs::AddressIndex index(*info);
+        std::printf("%04X: %s", pc, loader.Extent(unit).path.c_str());
+        if (auto function = index.FindFunction(bank, pc)) {
+            const std::string_view name = info->strings.Get(info->symbols[function->symbol].name);
+            std::printf(" %.*s+%u (saved %u, locals %u)", static_cast<int>(name.size()),
+                        name.data(), pc - function->start, function->frame.savedSize,
+                        function->frame.localsSize);
+        }
+        if (auto line = index.FindLine(bank, pc)) {
+            const std::string_view file = info->strings.Get(line->file);
+            std::printf(" %.*s:%u", static_cast<int>(file.size()), file.data(), line->line);
+        }
+        std::printf("\n");
+        return 0;
+    }
+
+    // text <[bank:]pc> <listing>...: prints the listing's instruction text at a (hex) PC
+    int Text(const Args& args) {
+        if (args.size() < 2)
+            return 1;
+        stabs::BankId bank;
+        uint32_t pc;
+        if (!ParseBankedAddress(args[0], bank, pc))
+            return 1;
+
+        stabs::ListingTextIndex index;
+        for (auto arg = args.begin() + 1; arg != args.end(); ++arg) {
+            std::string path;
+            stabs::BankId listingBank;
+            if (!ParseListingArg(*arg, path, listingBank))
+                return 1;
+            if (!index.AddListing(path, listingBank)) {
+                std::cerr << "Failed to read " << path << "\n";
+                return 1;
+            }
+        }
+
+        const std::string_view line = index.Find(bank, pc);
+        const std::string_view text = stabs::ListingTextIndex::InstructionText(line);
+        if (text.empty()) {
+            std::printf("%04X: no instruction\n", pc);
+            return 1;
+        }
+        std::printf("%04X: %.*s\n", pc, static_cast<int>(text.size()), text.data());
+        return 0;
+    }
+
+    template <typename RULE>
+    std::string_view RuleName() {
+        const std::string_view name = pegtl::demangle<RULE>();
+        return name.substr(name.rfind(':') + 1);
+    }
+
+    template <typename... RULES>
+    std::vector<std::string_view> RuleNames(pegtl::type_list<RULES...>) {
+        return {RuleName<RULES>()...};
+    }
+
+    // How often each alternative of the grammar's ordered_sors is tried and matched, by rule name
+    struct AlternativeCounts {
+        std::unordered_map<std::string_view, uint64_t> tries;
+        std::unordered_map<std::string_view, uint64_t> hits;
+
+        static uint64_t Get(const std::unordered_map<std::string_view, uint64_t>& counts,
+                            std::string_view rule) {
+            auto it = counts.find(rule);
+            return it != counts.end() ? it->second : 0;
+        }
+    };
+
+    template <typename RULE>
+    struct AlternativeRule {
+        using type = void;
+    };
+    template <typename RULE, typename ANCHOR>
+    struct AlternativeRule<stabs::alternative<RULE, ANCHOR>> {
+        using type = RULE;
+    };
+
+    template <typename RULE>
+    struct CountingControl : pegtl::normal<RULE> {
+        using Counted = typename AlternativeRule<RULE>::type;
+
+        template <typename Input>
+        static void start(const Input&, AlternativeCounts& counts) {
+            if constexpr (!std::is_void_v<Counted>)
+                ++counts.tries[RuleName<Counted>()];
+        }
+
+        template <typename Input>
+        static void success(const Input&, AlternativeCounts& counts) {
+            if constexpr (!std::is_void_v<Counted>)
+                ++counts.hits[RuleName<Counted>()];
+        }
+    };
+
+    // Alternatives tried if the choice used the given order. Alternatives are anchored, so each
+    // one matches the same inputs whatever its position.
+    uint64_t TriesFor(const std::vector<std::string_view>& order, uint64_t entries,
+                      const AlternativeCounts& counts) {
+        uint64_t tries = 0, matched = 0;
+        for (size_t i = 0; i < order.size(); ++i) {
+            const uint64_t hits = AlternativeCounts::Get(counts.hits, order[i]);
+            tries += hits * (i + 1);
+            matched += hits;
+        }
+        return tries + (entries - matched) * order.size();
+    }
+
+    // order <header> <listing>...: counts how often each alternative of the grammar's choices
+    // matches in the listings, and writes the header (stabs_grammar_order.h) with the most
+    // frequent alternatives first. Also times the compiled order, so running it again after a
+    // rebuild gives the before and after.
+    int Order(const Args& args) {
+        if (args.size() < 2)
+            return 1;
+
+        std::vector<stabs::MappedFile> files(args.size() - 1);
+        std::vector<std::string_view> lines;
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!files[i].Open(args[i + 1])) {
+                std::cerr << "Failed to read " << args[i + 1] << "\n";
+                return 1;
+            }
+            std::string_view text = files[i].Data();
+            while (!text.empty()) {
+                const size_t eol = text.find('\n');
+                std::string_view line = text.substr(0, eol);
+                text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+                lines.push_back(line);
+            }
+        }
+
+        const std::string source = "corpus";
+        size_t matched = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (auto line : lines) {
+            pegtl::memory_input<> in(line.data(), line.size(), source);
+            matched += pegtl::parse<stabs::listing_line>(in);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        AlternativeCounts counts;
+        for (auto line : lines) {
+            pegtl::memory_input<> in(line.data(), line.size(), source);
+            pegtl::parse<stabs::listing_line, pegtl::nothing, CountingControl>(in, counts);
+        }
+
+        struct Choice {
+            const char* list;
+            std::vector<std::string_view> rules; // Compiled order
+        };
+        const Choice choices[] = {
+            {"listing_line_order", RuleNames(stabs::listing_line_order{})},
+            {"stabs_directive_order", RuleNames(stabs::stabs_directive_order{})},
+            {"lsym_order", RuleNames(stabs::lsym_order{})},
+        };
+
+        std::vector<std::string_view> declarations;
+        for (auto& choice : choices)
+            declarations.insert(declarations.end(), choice.rules.begin(), choice.rules.end());
+        std::sort(declarations.begin(), declarations.end());
+
+        std::ofstream out(args[0]);
+        out << "// Generated by 'stabs-tool order' from " << files.size() << " listings ("
+            << lines.size() << " lines); regenerate rather than edit.\n"
+            << "//\n"
+            << "// Alternatives of the grammar's reorderable choices (ordered_sor in "
+               "stabs_grammar.h), most\n"
+            << "// frequently matched first. Each comment is the number of corpus matches.\n"
+            << "#pragma once\n\n"
+            << "#include <tao/pegtl/type_list.hpp>\n\n"
+            << "namespace stabs {\n";
+        for (auto& name : declarations)
+            out << "    struct " << name << ";\n";
+
+        for (auto& choice : choices) {
+            const uint64_t entries = AlternativeCounts::Get(counts.tries, choice.rules.front());
+            std::vector<std::string_view> order = choice.rules;
+            std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) {
+                return AlternativeCounts::Get(counts.hits, a) >
+                       AlternativeCounts::Get(counts.hits, b);
+            });
+
+            size_t width = 0;
+            for (auto& name : order)
+                width = std::max(width, name.size() + 1);
+            out << "\n    using " << choice.list << " = TAO_PEGTL_NAMESPACE::type_list<\n";
+            for (size_t i = 0; i < order.size(); ++i) {
+                std::string entry(order[i]);
+                if (i + 1 < order.size())
+                    entry += ',';
+                entry.resize(width, ' ');
+                out << "        " << entry << " // "
+                    << AlternativeCounts::Get(counts.hits, order[i]) << "\n";
+            }
+            out << "        >;\n";
+
+            std::cerr << choice.list << ": " << TriesFor(choice.rules, entries, counts)
+                      << " alternatives tried, " << TriesFor(order, entries, counts)
+                      << " with the measured order\n";
+        }
+        out << "\n} // namespace stabs\n";
+
+        std::cerr << lines.size() << " lines (" << matched << " matched) parsed in "
+                  << std::chrono::duration<double, std::milli>(elapsed).count()
+                  << " ms with the compiled order\n";
+        return out ? 0 : 1;
+    }
+
+    // tree [--dot|--json] <listing>...: the parse tree of every matching line, e.g. to diff
+    // the trees of two grammar versions
+    int Tree(const Args& args) {
+        const std::string_view option = args.empty() ? "" : args[0];
+        const stabs::TreeFormat format = option == "--dot"    ? stabs::TreeFormat::Dot
+                                         : option == "--json" ? stabs::TreeFormat::Json
+                                                              : stabs::TreeFormat::Text;
+        const size_t first = format == stabs::TreeFormat::Text ? 0 : 1;
+
+        stabs::BufferedWriter out(stdout);
+        stabs::ParseTreeDumper dumper(format, out);
+        dumper.Begin();
+        for (auto arg = args.begin() + first; arg != args.end(); ++arg) {
+            stabs::MappedFile file;
+            if (!file.Open(*arg)) {
+                std::cerr << "Failed to read " << *arg << "\n";
+                return 1;
+            }
+            std::string_view text = file.Data();
+            for (uint64_t lineNumber = 1; !text.empty(); ++lineNumber) {
+                const size_t eol = text.find('\n');
+                std::string_view line = text.substr(0, eol);
+                text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+
+                pegtl::memory_input<> in(line.data(), line.size(), *arg);
+                if (const auto root =
+                        pegtl::parse_tree::parse<stabs::listing_line, stabs::Node,
+                                                 stabs::selector>(in)) {
+                    dumper.Dump(*root, lineNumber);
+                }
+            }
+        }
+        dumper.End();
+        out.Flush();
+        return out.Failed() ? 1 : 0;
+    }
+
+    struct Command {
+        const char* name;
+        int (*run)(const Args& args);
+        const char* usage;
+    };
+
+    const Command commands[] = {
+        {"types", Types, "types <listing>..."},
+        {"diff", Diff, "diff <before-listing>... -- <after-listing>..."},
+        {"lines", Lines, "lines <source-root> <listing>..."},
+        {"resolve", Resolve, "resolve <[bank:]pc> <name> <listing>..."},
+        {"directpage", DirectPage, "directpage <listing>..."},
+        {"footprint", Footprint, "footprint [--json] <listing>..."},
+        {"export", Export, "export <listing>..."},
+        {"layout", Layout, "layout <listing>..."},
+        {"stack", Stack, "stack <listing>..."},
+        {"where", Where, "where <[bank:]pc> <listing>..."},
+        {"text", Text, "text <[bank:]pc> <listing>..."},
+        {"tree", Tree, "tree [--dot|--json] <listing>..."},
+        {"order", Order, "order <stabs_grammar_order.h> <listing>..."},
+    };
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 2) {
+        for (auto& command : commands) {
+            if (std::strcmp(argv[1], command.name) == 0)
+                return command.run(Args(argv + 2, argv + argc));
+        }
+    }
+
+    std::cerr << "Usage:\n";
+    for (auto& command : commands)
+        std::cerr << "  stabs-tool " << command.usage << "\n";
+    return 1;
+}
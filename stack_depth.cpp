@@ -0,0 +1,174 @@
+#include "stack_depth.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace stabs {
+    namespace {
+        constexpr uint32_t ReturnAddressSize = 2;
+
+        uint32_t FrameSize(const Function& function) {
+            return ReturnAddressSize + function.frame.savedSize + function.frame.localsSize;
+        }
+
+        // Labels are looked up in the caller's unit first, as static functions of different
+        // units may share a label
+        void ResolveCalls(DebugInfo& info) {
+            std::unordered_map<uint64_t, uint32_t> unitLabels;
+            std::unordered_map<StrId, uint32_t> labels;
+            for (uint32_t i = 0; i < info.functions.size(); ++i) {
+                const Symbol& symbol = info.symbols[info.functions[i].symbol];
+                unitLabels.try_emplace(uint64_t{symbol.unit} << 32 | symbol.label, i);
+                labels.try_emplace(symbol.label, i);
+            }
+
+            for (auto& call : info.calls) {
+                call.callee = InvalidIndex;
+                if (call.target == InvalidStrId)
+                    continue;
+                const uint32_t unit = info.symbols[info.functions[call.caller].symbol].unit;
+                if (auto unitIt = unitLabels.find(uint64_t{unit} << 32 | call.target);
+                    unitIt != unitLabels.end())
+                    call.callee = unitIt->second;
+                else if (auto globalIt = labels.find(call.target); globalIt != labels.end())
+                    call.callee = globalIt->second;
+            }
+        }
+    } // namespace
+
+    void ComputeStackDepths(DebugInfo& info) {
+        ResolveCalls(info);
+
+        // Call graph in compressed rows: the callees of function f are
+        // callees[firstCallee[f], firstCallee[f + 1]), InvalidIndex for unresolved calls, and
+        // pushedBytes[e] is what the caller has pushed beyond its frame at call e
+        const uint32_t numFunctions = static_cast<uint32_t>(info.functions.size());
+        std::vector<uint32_t> firstCallee(numFunctions + 1, 0);
+        for (auto& call : info.calls)
+            ++firstCallee[call.caller + 1];
+        for (uint32_t f = 0; f < numFunctions; ++f)
+            firstCallee[f + 1] += firstCallee[f];
+        std::vector<uint32_t> callees(info.calls.size());
+        std::vector<uint32_t> pushedBytes(info.calls.size());
+        {
+            std::vector<uint32_t> next(firstCallee.begin(), firstCallee.end() - 1);
+            for (auto& call : info.calls) {
+                pushedBytes[next[call.caller]] = call.pushedBytes;
+                callees[next[call.caller]++] = call.callee;
+            }
+        }
+
+        constexpr uint32_t Unvisited = InvalidIndex;
+        std::vector<uint32_t> order(numFunctions, Unvisited); // Tarjan's index
+        std::vector<uint32_t> low(numFunctions, 0);
+        std::vector<uint32_t> component(numFunctions, InvalidIndex);
+        std::vector<uint32_t> stack;   // Functions of components not finished yet
+        std::vector<uint32_t> members; // Of the component being finished
+        uint32_t nextOrder = 0, numComponents = 0;
+
+        struct Visit {
+            uint32_t function;
+            uint32_t nextEdge;
+        };
+        std::vector<Visit> visits;
+
+        auto start = [&](uint32_t f) {
+            order[f] = low[f] = nextOrder++;
+            stack.push_back(f);
+            visits.push_back({f, firstCallee[f]});
+        };
+
+        // Components finish callees first, so every callee outside the component is done
+        auto finish = [&](uint32_t root) {
+            members.clear();
+            uint32_t f;
+            do {
+                f = stack.back();
+                stack.pop_back();
+                component[f] = numComponents;
+                members.push_back(f);
+            } while (f != root);
+
+            uint32_t frames = 0, deepest = 0, deepestCallee = InvalidIndex;
+            bool recursive = members.size() > 1, incomplete = false;
+            for (uint32_t m : members) {
+                frames += FrameSize(info.functions[m]);
+                for (uint32_t e = firstCallee[m]; e < firstCallee[m + 1]; ++e) {
+                    const uint32_t callee = callees[e];
+                    if (callee == InvalidIndex) {
+                        incomplete = true;
+                    } else if (component[callee] == numComponents) {
+                        recursive = true;
+                    } else {
+                        const Function& c = info.functions[callee];
+                        incomplete |= c.incomplete;
+                        const uint32_t depth = pushedBytes[e] + c.maxStack;
+                        if (deepestCallee == InvalidIndex || depth > deepest) {
+                            deepest = depth;
+                            deepestCallee = callee;
+                        }
+                    }
+                }
+            }
+            for (uint32_t m : members) {
+                Function& function = info.functions[m];
+                function.maxStack = frames + deepest;
+                function.deepestCallee = deepestCallee;
+                function.recursive = recursive;
+                function.incomplete = incomplete;
+            }
+            ++numComponents;
+        };
+
+        for (uint32_t root = 0; root < numFunctions; ++root) {
+            if (order[root] != Unvisited)
+                continue;
+            start(root);
+            while (!visits.empty()) {
+                const uint32_t f = visits.back().function;
+                if (visits.back().nextEdge < firstCallee[f + 1]) {
+                    const uint32_t callee = callees[visits.back().nextEdge++];
+                    if (callee == InvalidIndex)
+                        continue;
+                    if (order[callee] == Unvisited)
+                        start(callee);
+                    else if (component[callee] == InvalidIndex)
+                        low[f] = std::min(low[f], order[callee]);
+                    continue;
+                }
+
+                visits.pop_back();
+                if (!visits.empty()) {
+                    const uint32_t caller = visits.back().function;
+                    low[caller] = std::min(low[caller], low[f]);
+                }
+                if (low[f] == order[f])
+                    finish(f);
+            }
+        }
+    }
+
+    std::vector<uint32_t> StackEntryPoints(const DebugInfo& info) {
+        std::vector<bool> called(info.functions.size(), false);
+        for (auto& call : info.calls) {
+            if (call.callee != InvalidIndex && call.callee != call.caller)
+                called[call.callee] = true;
+        }
+        std::vector<uint32_t> entries;
+        for (uint32_t f = 0; f < info.functions.size(); ++f) {
+            if (!called[f])
+                entries.push_back(f);
+        }
+        return entries;
+    }
+
+    std::vector<uint32_t> DeepestPath(const DebugInfo& info, uint32_t function) {
+        std::vector<uint32_t> path;
+        while (function != InvalidIndex && path.size() < info.functions.size()) {
+            path.push_back(function);
+            function = info.functions[function].deepestCallee;
+        }
+        return path;
+    }
+
+} // namespace stabs
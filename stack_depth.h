@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    // Resolves the targets of info.calls to functions, then computes the worst-case stack use
+    // of every function (Function::maxStack, deepestCallee, recursive and incomplete) from the
+    // frame layouts of the prologues. The call graph is condensed into its strongly connected
+    // components as they are found (Tarjan), and each component is finished once everything it
+    // calls is, so the whole program takes one linear pass.
+    //
+    // A function's own use is the return address pushed by its caller plus its prologue's
+    // frame. A call adds what the caller has pushed beyond its frame (Call::pushedBytes, e.g.
+    // arguments) to the callee's use. A call cycle counts each of its functions once, however
+    // deep the recursion goes, and is flagged; the bytes pushed for calls within it aren't
+    // counted.
+    //
+    // Run once after the last unit is loaded, as a unit may call functions of units loaded
+    // before or after it; LoadListing doesn't run it.
+    void ComputeStackDepths(DebugInfo& info);
+
+    // Functions that no resolved call targets: main, interrupt handlers, and functions only
+    // called through pointers
+    std::vector<uint32_t> StackEntryPoints(const DebugInfo& info);
+
+    // The function followed by its deepest callees: the path that uses the most stack
+    std::vector<uint32_t> DeepestPath(const DebugInfo& info, uint32_t function);
+
+} // namespace stabs
@@ -0,0 +1,198 @@
+#include "struct_layout.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace stabs {
+    namespace {
+        // Typedefs and qualifiers don't change the layout
+        TypeId Underlying(const DebugInfo& info, TypeId id) {
+            for (int depth = 0; id < info.types.size() && depth < 32; ++depth) {
+                const Type& type = info.types[id];
+                if (type.kind != TypeKind::Typedef && type.kind != TypeKind::Const &&
+                    type.kind != TypeKind::Volatile)
+                    break;
+                id = type.target;
+            }
+            return id;
+        }
+
+        class LayoutAnalyzer {
+        public:
+            LayoutAnalyzer(const DebugInfo& info, const LayoutOptions& options)
+                : m_info(info)
+                , m_options(options)
+                , m_alignments(info.types.size(), 0) {}
+
+            uint32_t Alignment(TypeId id, int depth = 0) {
+                id = Underlying(m_info, id);
+                if (id >= m_info.types.size() || depth > 32)
+                    return 1;
+                if (m_alignments[id] != 0)
+                    return m_alignments[id];
+
+                const Type& type = m_info.types[id];
+                uint32_t alignment = 1;
+                switch (type.kind) {
+                case TypeKind::Array:
+                    alignment = Alignment(type.target, depth + 1);
+                    break;
+                case TypeKind::Struct:
+                case TypeKind::Union:
+                    for (uint32_t m = type.first; m < type.first + type.numChildren; ++m)
+                        alignment = std::max(alignment,
+                                             Alignment(m_info.members[m].type, depth + 1));
+                    for (uint32_t b = type.firstBase; b < type.firstBase + type.numBases; ++b)
+                        alignment = std::max(alignment,
+                                             Alignment(m_info.baseClasses[b].type, depth + 1));
+                    break;
+                default:
+                    alignment = std::max(type.byteSize, 1u);
+                    break;
+                }
+                alignment = std::min(alignment, std::max(m_options.maxAlignment, 1u));
+                m_alignments[id] = alignment;
+                return alignment;
+            }
+
+            // False if the struct can't be analyzed (members of unknown size)
+            bool Analyze(TypeId id, LayoutSuggestion& suggestion) {
+                const Type& type = m_info.types[id];
+                suggestion.type = id;
+                suggestion.byteSize = type.byteSize;
+
+                // C++ base classes keep their offsets; the members are reordered after them
+                uint32_t basesEnd = 0, usedBits = 0, structAlignment = 1;
+                for (uint32_t b = type.firstBase; b < type.firstBase + type.numBases; ++b) {
+                    const BaseClass& base = m_info.baseClasses[b];
+                    const TypeId baseType = Underlying(m_info, base.type);
+                    if (baseType >= m_info.types.size() || base.bitOffset % 8 != 0)
+                        return false;
+                    const uint32_t size = m_info.types[baseType].byteSize;
+                    usedBits += size * 8;
+                    basesEnd = std::max(basesEnd, base.bitOffset / 8 + size);
+                    structAlignment = std::max(structAlignment, Alignment(baseType));
+                }
+
+                m_bytes.clear();
+                m_bits.clear();
+                for (uint32_t m = type.first; m < type.first + type.numChildren; ++m) {
+                    const StructMember& member = m_info.members[m];
+                    const TypeId memberType = Underlying(m_info, member.type);
+                    if (memberType >= m_info.types.size())
+                        return false;
+                    const uint32_t size = m_info.types[memberType].byteSize;
+                    if (size == 0 && member.bitSize == 0)
+                        return false;
+                    usedBits += member.bitSize;
+                    const uint32_t alignment = Alignment(memberType);
+                    structAlignment = std::max(structAlignment, alignment);
+                    if (member.bitSize != size * 8 || member.bitOffset % 8 != 0)
+                        m_bits.push_back({m, member.bitSize, alignment});
+                    else
+                        m_bytes.push_back({m, size, alignment});
+                }
+                const uint32_t totalBits = type.byteSize * 8;
+                suggestion.holeBits = usedBits < totalBits ? totalBits - usedBits : 0;
+
+                std::stable_sort(m_bytes.begin(), m_bytes.end(), [](auto& a, auto& b) {
+                    return a.alignment > b.alignment;
+                });
+                std::stable_sort(m_bits.begin(), m_bits.end(),
+                                 [](auto& a, auto& b) { return a.size > b.size; });
+
+                uint32_t offset = basesEnd;
+                suggestion.order.clear();
+                for (auto& member : m_bytes) {
+                    offset = AlignUp(offset, member.alignment) + member.size;
+                    suggestion.order.push_back(member.index);
+                }
+                uint32_t bits = 0;
+                for (auto& member : m_bits) {
+                    bits += member.size;
+                    suggestion.order.push_back(member.index);
+                }
+                offset += (bits + 7) / 8;
+                suggestion.compactSize = AlignUp(offset, structAlignment);
+                return true;
+            }
+
+        private:
+            struct Placed {
+                uint32_t index;
+                uint32_t size; // Bytes, or bits for bit-fields
+                uint32_t alignment;
+            };
+
+            static uint32_t AlignUp(uint32_t offset, uint32_t alignment) {
+                return (offset + alignment - 1) / alignment * alignment;
+            }
+
+            const DebugInfo& m_info;
+            const LayoutOptions& m_options;
+            std::vector<uint32_t> m_alignments; // 0 until computed
+            std::vector<Placed> m_bytes;
+            std::vector<Placed> m_bits;
+        };
+    } // namespace
+
+    std::vector<LayoutSuggestion> AdviseStructLayouts(const DebugInfo& info,
+                                                      const LayoutOptions& options) {
+        LayoutAnalyzer analyzer(info, options);
+
+        // One pass over the types: each named struct is analyzed at its first definition, and
+        // later definitions map to that one
+        std::unordered_map<StrId, uint32_t> byName;
+        std::unordered_map<TypeId, uint32_t> byType; // Into suggestions
+        std::vector<LayoutSuggestion> suggestions;
+        LayoutSuggestion suggestion;
+        for (TypeId id = 0; id < info.types.size(); ++id) {
+            const Type& type = info.types[id];
+            if (type.kind != TypeKind::Struct || type.numChildren == 0 || type.byteSize == 0)
+                continue;
+            if (type.name != 0) {
+                if (auto it = byName.find(type.name); it != byName.end()) {
+                    byType.emplace(id, it->second);
+                    continue;
+                }
+            }
+            if (!analyzer.Analyze(id, suggestion))
+                continue;
+            const auto index = static_cast<uint32_t>(suggestions.size());
+            if (type.name != 0)
+                byName.emplace(type.name, index);
+            byType.emplace(id, index);
+            suggestions.push_back(suggestion);
+        }
+
+        // Instances in static data
+        for (auto& symbol : info.symbols) {
+            if (symbol.kind == SymbolKind::Function)
+                continue;
+            uint64_t count = 1;
+            TypeId id = Underlying(info, symbol.type);
+            for (int depth = 0; id < info.types.size() && depth < 32; ++depth) {
+                if (info.types[id].kind != TypeKind::Array)
+                    break;
+                count *= info.types[id].count;
+                id = Underlying(info, info.types[id].target);
+            }
+            if (auto it = byType.find(id); it != byType.end())
+                suggestions[it->second].instances += count;
+        }
+
+        suggestions.erase(std::remove_if(suggestions.begin(), suggestions.end(),
+                                         [](auto& s) { return s.compactSize >= s.byteSize; }),
+                          suggestions.end());
+        auto saved = [](const LayoutSuggestion& s) {
+            return uint64_t{s.byteSize - s.compactSize} * s.instances;
+        };
+        std::sort(suggestions.begin(), suggestions.end(), [&](auto& a, auto& b) {
+            if (saved(a) != saved(b))
+                return saved(a) > saved(b);
+            return a.byteSize - a.compactSize > b.byteSize - b.compactSize;
+        });
+        return suggestions;
+    }
+
+} // namespace stabs
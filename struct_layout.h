@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "debug_info.h"
+
+namespace stabs {
+
+    struct LayoutOptions {
+        // Largest alignment the ABI gives a member; the 6809 has none, so only bit-field holes
+        // and the tails of bit-field units are wasted
+        uint32_t maxAlignment = 1;
+    };
+
+    struct LayoutSuggestion {
+        TypeId type = InvalidTypeId; // First definition of the struct
+        uint32_t byteSize = 0;
+        uint32_t holeBits = 0;    // Padding and bit-field holes, including after the last member
+        uint32_t compactSize = 0; // Bytes with the suggested member order
+        uint64_t instances = 0;   // In static data: variables and their array elements
+        std::vector<uint32_t> order; // Members (indices into DebugInfo::members), new order
+    };
+
+    // Finds the structs whose members could be reordered to take less space: members by
+    // decreasing alignment, then the bit-fields packed together. Structs defined in several
+    // units (from a shared header) are analyzed once, and their instances in every unit's
+    // static data are added up. Sorted by bytes saved over all instances, then per instance.
+    //
+    // C++ base classes stay where they are, and the members are packed after the last of them.
+    // Packing treats the bit-fields as one run of bits, as if fields could straddle the units
+    // of their declared types; the compact size is a lower bound where they can't.
+    std::vector<LayoutSuggestion> AdviseStructLayouts(const DebugInfo& info,
+                                                      const LayoutOptions& options = {});
+
+} // namespace stabs
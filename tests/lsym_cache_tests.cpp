@@ -0,0 +1,105 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lsym_cache.h"
+#include "test_util.h"
+
+namespace {
+    using namespace stabs;
+
+    void TestNormalize() {
+        std::string key;
+        std::vector<std::string_view> numbers;
+        NormalizeLsym("bool:t22=eFalse:0,True:1,;", key, numbers);
+        CHECK(key == "bool:t#=eFalse:#,True:#,;");
+        CHECK((numbers == std::vector<std::string_view>{"22", "0", "1"}));
+
+        // Names keep their digits; the member visibility digit ("/2") stays in the key
+        NormalizeLsym("Bar:Tt27=s6!1,020,26;c2:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;", key,
+                      numbers);
+        CHECK(key == "Bar:Tt#=s#!#,#,#;c2:/2#,#,#;get::#=###;:_ZN3Bar3getEv;#A.;;");
+        CHECK((numbers == std::vector<std::string_view>{"27", "6", "1", "020", "26", "13", "32",
+                                                        "8", "28", "7", "2"}));
+    }
+
+    void TestCheckNumbers() {
+        LsymRecord record;
+        record.bases.push_back({0, 1});
+        record.methods.push_back({"get", "_ZN3Bar3getEv", 1, 2});
+
+        auto check = [&](std::vector<std::string_view> numbers) {
+            return CheckLsymNumbers(record, numbers);
+        };
+        CHECK(check({"020", "26", "2"}));
+        CHECK(check({"1216", "26", "0"}));
+        CHECK(!check({"720", "26", "2"}));  // Virtual flag
+        CHECK(!check({"030", "26", "2"}));  // Base access
+        CHECK(!check({"02", "26", "2"}));   // No offset
+        CHECK(!check({"-20", "26", "2"}));
+        CHECK(!check({"020", "26", "7"}));  // Method access
+        CHECK(!check({"020", "26", "12"}));
+    }
+
+    DebugInfo Load(std::string_view lsym, LsymCache& cache) {
+        DebugInfo info;
+        LoadOptions options;
+        options.lsymCache = &cache;
+        LoadListing(test::LsymListing({lsym}), "test.lst", info, options);
+        return info;
+    }
+
+    // A string whose shape is cached is applied from the cache, with its own numbers, and
+    // gives the same tables as decoding it
+    void TestHit(std::string_view warm, std::string_view probe, bool valid) {
+        LsymCache cold;
+        const DebugInfo reference = Load(probe, cold);
+
+        LsymCache cache;
+        Load(warm, cache);
+        const size_t cached = cache.Size();
+        CHECK_FOR(cached == 1, warm);
+        const DebugInfo hit = Load(probe, cache);
+        CHECK_FOR(cache.Size() == cached, probe);
+        CHECK_FOR(test::SameTypes(reference, hit), probe);
+        // The grammar rejects the string, so nothing may come of it from the cache either
+        if (!valid)
+            CHECK_FOR(hit.methods.empty() && hit.baseClasses.empty(), probe);
+    }
+
+    void TestHits() {
+        TestHit("bool:t22=eFalse:0,True:1,;", "bool:t40=eFalse:7,True:-9,;", true);
+        TestHit("Foo:T26=s4a:7,0,8;b:7,8,8;;", "Foo:T31=s6a:9,0,16;b:9,16,32;;", true);
+        TestHit("c:25=ar26=r26;0;-1;;0;9;7", "c:35=ar36=r36;0;-1;;0;19;13", true);
+
+        const std::string_view bar =
+            "Bar:Tt27=s6!1,020,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;";
+        TestHit(bar, "Bar:Tt37=s8!1,116,36;c:/223,48,8;get::38=##23;:_ZN3Bar3getEv;1A.;;",
+                true);
+        // Numbers that only differ in the slots the grammar restricts
+        TestHit(bar, "Bar:Tt27=s6!1,020,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;7A.;;",
+                false);
+        TestHit(bar, "Bar:Tt27=s6!1,720,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;",
+                false);
+        TestHit(bar, "Bar:Tt27=s6!1,030,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;",
+                false);
+
+        // The record's numbers come from the probe
+        LsymCache cache;
+        Load(bar, cache);
+        const DebugInfo hit = Load(
+            "Bar:Tt37=s8!1,116,36;c:/223,48,8;get::38=##23;:_ZN3Bar3getEv;1A.;;", cache);
+        CHECK(hit.baseClasses.size() == 1 && hit.baseClasses[0].isVirtual &&
+              hit.baseClasses[0].access == Access::Protected &&
+              hit.baseClasses[0].bitOffset == 6);
+        CHECK(hit.methods.size() == 1 && hit.methods[0].access == Access::Protected);
+        CHECK(hit.members.size() == 1 && hit.members[0].bitOffset == 48);
+    }
+} // namespace
+
+int main() {
+    TestNormalize();
+    TestCheckNumbers();
+    TestHits();
+    return stabs::test::Failures();
+}
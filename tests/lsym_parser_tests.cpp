@@ -0,0 +1,123 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lsym_cache.h"
+#include "test_util.h"
+
+namespace {
+    using namespace stabs;
+
+    // N_LSYM strings of C and C++ units, and a few malformed ones that both decoders must
+    // reject
+    const std::vector<std::string_view> corpus = {
+        // Base types and ranges, including the octal bounds of 64-bit types
+        "int:t7=r7;-32768;32767;",
+        "char:t13=r13;0;255;",
+        "unsigned int:t8=r8;0;65535;",
+        "long long int:t9=r9;01000000000000000000000;0777777777777777777777;",
+        "long long unsigned int:t10=r10;0;01777777777777777777777;",
+        "float:t11=r7;4;0;",
+        "double:t12=r7;8;0;",
+        "complex long double:t3=R3;8;0;",
+        "void:t14=14",
+        // Typedefs, pointers, qualifiers and functions
+        "myint:t26=7",
+        "a:7",
+        "var1:7",
+        "p:25=*7",
+        "pp:27=*25",
+        "ppp:28=*27",
+        "c:26=k7",
+        "v:26=B7",
+        "fn:26=f7",
+        // Arrays
+        "b:30=ar28;0;2;22",
+        "pi:31=ar28;0;3;32=*7",
+        "c:25=ar26=r26;0;-1;;0;9;27=ar26;0;10;28=ar26;0;11;7",
+        // Enums
+        "bool:t22=eFalse:0,True:1,;",
+        "WeekDay:t25=eMonday:0,Tuesday:1,Wednesday:2,EndOfDays:2,Foo:-5000,;",
+        // Structs, unions and cross references
+        "Bar:T25=s3x:7,0,8;y:7,8,8;z:7,16,8;;",
+        "Foo:T27=s14a:18,0,32;b:22,32,8;c:25,40,16;bar:26,56,24;d:7,80,6;e:7,86,2;f:7,88,8;"
+        "p:28=*7,96,16;;",
+        "U:T26=u2a:7,0,16;b:13,0,8;;",
+        "Nested:T40=s4in:41=s2x:7,0,16;;,0,16;y:7,16,16;;",
+        "Fwd:t30=xsFwd:",
+        "pf:31=*32=xsFwd:",
+        // C++ classes: bases, visibility, methods and vtables
+        "Bar:Tt27=s6!1,020,26;c:/213,32,8;get::28=##7;:_ZN3Bar3getEv;2A.;;",
+        "Two:Tt33=s8!2,020,26;1160,27;d:/07,48,16;;",
+        "Calc:Tt34=s2x:/17,0,16;add::35=#34,7,34,7;:_ZN4Calc3addEi;2A.;make::36=##34;"
+        ":_ZN4Calc4makeEv;2A?;;",
+        "Base:Tt37=s4$vf37:38=*39=*40=f7,0,16;x:/27,16,16;f::41=##7;:_ZN4Base1fEv;2A*0;37;;;"
+        "~%37;",
+        "Over:Tt42=s2get::43=##7;:_ZN4Over3getEv;2A.44=##13;:_ZNK4Over3getEv;0B.;;",
+        // Rejected by the grammar
+        "Bar:Tt27=s6!1,720,26;c:/213,32,8;;",
+        "Bar:Tt27=s6get::28=##7;:_ZN3Bar3getEv;7A.;;",
+        "x:",
+        ":t7",
+        "e:t22=eFalse:0,True:1,",
+    };
+
+    DebugInfo Load(const std::vector<std::string_view>& lsyms, LsymParser parser) {
+        // A cache of its own, so every string is decoded by the parser under test
+        LsymCache cache;
+        DebugInfo info;
+        LoadOptions options;
+        options.lsymParser = parser;
+        options.lsymCache = &cache;
+        LoadListing(test::LsymListing(lsyms), "test.lst", info, options);
+        return info;
+    }
+
+    const Type* FindType(const DebugInfo& info, std::string_view name) {
+        for (auto& type : info.types) {
+            if (info.strings.Get(type.name) == name)
+                return &type;
+        }
+        return nullptr;
+    }
+
+    // Each string alone, so a difference is reported with its input
+    void TestEachString() {
+        for (auto lsym : corpus) {
+            const DebugInfo grammar = Load({lsym}, LsymParser::Grammar);
+            const DebugInfo tokens = Load({lsym}, LsymParser::Tokens);
+            CHECK_FOR(test::SameTypes(grammar, tokens), lsym);
+        }
+    }
+
+    // All strings in one unit, where later strings refer to the type numbers of earlier ones
+    void TestCorpus() {
+        const DebugInfo grammar = Load(corpus, LsymParser::Grammar);
+        const DebugInfo tokens = Load(corpus, LsymParser::Tokens);
+        CHECK(test::SameTypes(grammar, tokens));
+        CHECK(!grammar.members.empty() && !grammar.enumerators.empty() &&
+              !grammar.baseClasses.empty() && !grammar.methods.empty());
+    }
+
+    // Octal bounds are wider than int64; both decoders keep them as text
+    void TestRangeBounds() {
+        for (auto parser : {LsymParser::Grammar, LsymParser::Tokens}) {
+            const DebugInfo info = Load(corpus, parser);
+            const Type* signed64 = FindType(info, "long long int");
+            const Type* unsigned64 = FindType(info, "long long unsigned int");
+            CHECK(signed64 && signed64->byteSize == 8);
+            CHECK(unsigned64 && unsigned64->byteSize == 8);
+            const Type* int16 = FindType(info, "int");
+            CHECK(int16 && int16->byteSize == 2);
+            const Type* float32 = FindType(info, "float");
+            CHECK(float32 && float32->byteSize == 4);
+        }
+    }
+} // namespace
+
+int main() {
+    TestEachString();
+    TestCorpus();
+    TestRangeBounds();
+    return stabs::test::Failures();
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "debug_info.h"
+#include "listing_loader.h"
+
+// Minimal checks for the test executables: a failed CHECK is reported and counted, and main
+// returns the count, so ctest sees any failure.
+namespace stabs::test {
+
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline void Check(bool passed, const char* expression, const char* file, int line,
+                      std::string_view context = {}) {
+        if (passed)
+            return;
+        ++Failures();
+        std::printf("%s:%d: CHECK(%s) failed", file, line, expression);
+        if (!context.empty())
+            std::printf(" for %.*s", static_cast<int>(context.size()), context.data());
+        std::printf("\n");
+    }
+
+#define CHECK(condition) \
+    ::stabs::test::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+// Also prints context, e.g. the input, with a failure
+#define CHECK_FOR(condition, context) \
+    ::stabs::test::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__, context)
+
+    // A listing with one N_LSYM line per string
+    //   40 ;	.stabs	"int:t7",128,0,0,0
+    inline std::string LsymListing(const std::vector<std::string_view>& lsyms) {
+        std::string listing;
+        int line = 1;
+        for (auto lsym : lsyms) {
+            listing += "                            " + std::to_string(line++) + " ;\t.stabs\t\"";
+            listing.append(lsym.data(), lsym.size());
+            listing += "\",128,0,0,0\n";
+        }
+        return listing;
+    }
+
+    // Whether two loads produced the same types and the records they own. Names are compared
+    // as strings, as each DebugInfo has its own string pool.
+    inline bool SameTypes(const DebugInfo& a, const DebugInfo& b) {
+        auto name = [](const DebugInfo& info, StrId id) { return info.strings.Get(id); };
+        if (a.types.size() != b.types.size() || a.members.size() != b.members.size() ||
+            a.enumerators.size() != b.enumerators.size() ||
+            a.baseClasses.size() != b.baseClasses.size() || a.methods.size() != b.methods.size())
+            return false;
+        for (size_t i = 0; i < a.types.size(); ++i) {
+            const Type& x = a.types[i];
+            const Type& y = b.types[i];
+            if (x.kind != y.kind || name(a, x.name) != name(b, y.name) || x.target != y.target ||
+                x.count != y.count || x.byteSize != y.byteSize || x.first != y.first ||
+                x.numChildren != y.numChildren || x.firstBase != y.firstBase ||
+                x.numBases != y.numBases || x.firstMethod != y.firstMethod ||
+                x.numMethods != y.numMethods || x.stabsId != y.stabsId)
+                return false;
+        }
+        for (size_t i = 0; i < a.members.size(); ++i) {
+            const StructMember& x = a.members[i];
+            const StructMember& y = b.members[i];
+            if (name(a, x.name) != name(b, y.name) || x.type != y.type ||
+                x.bitOffset != y.bitOffset || x.bitSize != y.bitSize)
+                return false;
+        }
+        for (size_t i = 0; i < a.enumerators.size(); ++i) {
+            if (name(a, a.enumerators[i].name) != name(b, b.enumerators[i].name) ||
+                a.enumerators[i].value != b.enumerators[i].value)
+                return false;
+        }
+        for (size_t i = 0; i < a.baseClasses.size(); ++i) {
+            const BaseClass& x = a.baseClasses[i];
+            const BaseClass& y = b.baseClasses[i];
+            if (x.type != y.type || x.bitOffset != y.bitOffset || x.access != y.access ||
+                x.isVirtual != y.isVirtual)
+                return false;
+        }
+        for (size_t i = 0; i < a.methods.size(); ++i) {
+            const Method& x = a.methods[i];
+            const Method& y = b.methods[i];
+            if (name(a, x.name) != name(b, y.name) || name(a, x.physName) != name(b, y.physName) ||
+                x.type != y.type || x.access != y.access || x.isVirtual != y.isVirtual ||
+                x.isStatic != y.isStatic)
+                return false;
+        }
+        return true;
+    }
+
+} // namespace stabs::test
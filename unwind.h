@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "address_index.h"
+#include "debug_info.h"
+
+namespace stabs {
+
+    struct StackFrame {
+        uint32_t function = InvalidIndex; // Index into DebugInfo::functions
+        uint32_t pc = 0;
+        uint32_t sp = 0; // S while the frame's function runs at pc
+        // Address of the frame's saved registers (see SavedRegisterAddress), or InvalidAddress
+        // if the prologue hasn't pushed them yet or the epilogue has pulled them
+        uint32_t savedRegisters = InvalidAddress;
+    };
+
+    // Address of a register that the prologue saved (a pshs postbyte bit: 0x40 for U), or
+    // InvalidAddress if it didn't save it. pshs stores CC at the lowest address up to PC at the
+    // highest.
+    inline uint32_t SavedRegisterAddress(const FrameLayout& frame, uint32_t savedRegisters,
+                                         uint8_t reg) {
+        if (savedRegisters == InvalidAddress || (frame.savedRegisters & reg) == 0)
+            return InvalidAddress;
+        uint32_t address = savedRegisters;
+        for (uint8_t bit = 1; bit != reg; bit <<= 1) {
+            if (frame.savedRegisters & bit)
+                address += bit >= 0x10 ? 2 : 1;
+        }
+        return address;
+    }
+
+    // Bytes the function has on the stack below its return address when it runs at pc, or
+    // UnknownStackDepth
+    inline uint32_t StackDepthAt(const DebugInfo& info, const Function& function, uint32_t pc) {
+        const auto begin = info.stackDepths.begin() + function.firstStackDepth;
+        const auto end = begin + function.numStackDepths;
+        auto it = std::upper_bound(begin, end, pc - function.start,
+                                   [](uint32_t offset, const StackDepth& depth) {
+                                       return offset < depth.offset;
+                                   });
+        return it != begin ? std::prev(it)->depth : UnknownStackDepth;
+    }
+
+    // Builds the call stack from the PC and S of a break, innermost frame first, from the stack
+    // depths the loader followed through each function: each frame is one function lookup, one
+    // binary search of its depths and one read of the return address. readWord reads the
+    // big-endian 16-bit word at an address. Callers are looked up in the same bank.
+    //
+    // Stops at code outside any known function, after a frame whose depth at its PC is unknown
+    // (S loaded from a register, or compiler output), or after maxFrames.
+    template <typename READ_WORD>
+    void BuildCallStack(const DebugInfo& info, const AddressIndex& index, BankId bank,
+                        uint32_t pc, uint32_t sp, READ_WORD&& readWord,
+                        std::vector<StackFrame>& frames, size_t maxFrames = 64) {
+        frames.clear();
+        while (frames.size() < maxFrames) {
+            const Function* function = index.FindFunction(bank, pc);
+            if (!function)
+                break;
+            const FrameLayout& frame = function->frame;
+            const uint32_t depth = StackDepthAt(info, *function, pc);
+
+            StackFrame entry;
+            entry.function = static_cast<uint32_t>(function - info.functions.data());
+            entry.pc = pc;
+            entry.sp = sp;
+            // The saved registers sit just below the return address from the pshs on, until
+            // the epilogue pulls them
+            if (depth != UnknownStackDepth && frame.pushEnd != 0 &&
+                pc - function->start >= frame.pushEnd && depth >= frame.savedSize)
+                entry.savedRegisters = sp + depth - frame.savedSize;
+            frames.push_back(entry);
+            if (depth == UnknownStackDepth)
+                break;
+
+            const uint32_t returnAddress = sp + depth;
+            pc = readWord(returnAddress & 0xFFFF);
+            sp = returnAddress + 2;
+        }
+    }
+
+} // namespace stabs